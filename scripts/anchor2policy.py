@@ -0,0 +1,91 @@
+"""Convert a LIBLINEAR policy with one weight block per depth decile and branching direction into a depth anchor
+policy, whose weights are interpolated between a few anchors of the relative depth and stored in low rank.
+
+The block of depth decile d and direction b starts at LIBSVM index featsize * (2 * d + b) + 1 and covers the relative
+depth feature values [d, d + 1). The anchor weights are fitted by least squares to the blocks at the centers of their
+deciles; blocks beyond the model count as zero weights, like in the linear policy. The anchor weights of both
+directions are then truncated to the given rank by a singular value decomposition. The policy file is
+
+   anchor <featsize> <depthfeature> <nanchors> <rank>
+   <anchor_1> ... <anchor_nanchors>
+   <basis vector>                                 rank lines of featsize values
+   <coefficients>                                 2 * nanchors lines of rank values, down and up for each anchor
+
+Usage:
+   anchor2policy.py <model> <out> --featsize <n> --depthfeature <i> [--anchors 0,5,10] [--rank <r>]
+"""
+from __future__ import print_function
+import argparse
+import numpy as np
+
+HEADERSIZE_LIBSVM = 6
+NDECILES = 10
+
+
+def read_model(fname):
+   with open(fname, 'r') as fin:
+      lines = fin.readlines()[HEADERSIZE_LIBSVM:]
+   return np.array([float(line) for line in lines if line.strip()])
+
+
+def hat(depths, anchors):
+   """interpolation factors of the anchors at the depths, constant beyond the first and the last anchor"""
+   h = np.zeros((len(depths), len(anchors)))
+   for i, depth in enumerate(depths):
+      if depth <= anchors[0]:
+         h[i, 0] = 1.0
+      elif depth >= anchors[-1]:
+         h[i, -1] = 1.0
+      else:
+         k = np.searchsorted(anchors, depth, side='right') - 1
+         t = (depth - anchors[k]) / (anchors[k + 1] - anchors[k])
+         h[i, k] = 1.0 - t
+         h[i, k + 1] = t
+   return h
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='convert a depth decile policy to a depth anchor policy')
+   parser.add_argument('model', help='LIBLINEAR model')
+   parser.add_argument('out', help='policy file to write')
+   parser.add_argument('--featsize', type=int, required=True, help='number of features of a node (18 for search, 16 for kill)')
+   parser.add_argument('--depthfeature', type=int, required=True,
+      help='index of the relative depth among the features, starting at 1 (18 for search, 6 for kill)')
+   parser.add_argument('--anchors', default='0,2.5,5,10', help='comma-separated increasing anchors of the relative depth')
+   parser.add_argument('--rank', type=int, default=4, help='rank of the anchor weights')
+   args = parser.parse_args()
+
+   weights = read_model(args.model)
+   anchors = np.array([float(a) for a in args.anchors.split(',')])
+   assert np.all(np.diff(anchors) > 0)
+
+   # blocks[d, b] is the weight vector of depth decile d and direction b
+   nblocks = 2 * NDECILES
+   padded = np.zeros(nblocks * args.featsize)
+   n = min(len(weights), len(padded))
+   padded[:n] = weights[:n]
+   blocks = padded.reshape(NDECILES, 2, args.featsize)
+
+   h = hat(np.arange(NDECILES) + 0.5, anchors)
+   anchorweights = np.zeros((len(anchors), 2, args.featsize))
+   for b in range(2):
+      anchorweights[:, b, :] = np.linalg.lstsq(h, blocks[:, b, :], rcond=None)[0]
+
+   flat = anchorweights.reshape(2 * len(anchors), args.featsize)
+   u, s, vt = np.linalg.svd(flat, full_matrices=False)
+   rank = min(args.rank, len(s))
+   coefs = u[:, :rank] * s[:rank]
+   basis = vt[:rank]
+
+   fitted = np.einsum('dk,kbf->dbf', h, (coefs.dot(basis)).reshape(len(anchors), 2, args.featsize))
+   err = np.linalg.norm(fitted - blocks) / max(np.linalg.norm(blocks), 1e-12)
+
+   with open(args.out, 'w') as fout:
+      fout.write('anchor %d %d %d %d\n' % (args.featsize, args.depthfeature, len(anchors), rank))
+      fout.write(' '.join('%.10g' % a for a in anchors) + '\n')
+      for row in basis:
+         fout.write(' '.join('%.10g' % v for v in row) + '\n')
+      for row in coefs:
+         fout.write(' '.join('%.10g' % v for v in row) + '\n')
+   print('wrote %d anchors of rank %d to %s (%d weights instead of %d), relative error %g'
+      % (len(anchors), rank, args.out, rank * (args.featsize + 2 * len(anchors)), len(weights), err))
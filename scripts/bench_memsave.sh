@@ -0,0 +1,97 @@
+#!/bin/bash
+# ========================================
+# compare the policy node selector in memory
+# saving mode (memsavepriority 200000) with
+# SCIP's depth first search (memsavepriority 0)
+# under the same node and memory limits;
+# logs are kept in the output directory
+# ========================================
+
+set -e
+
+usage() {
+  echo "Usage: $0 -d <data_path_under_dat> -s <search_policy> [-k <kill_policy>] -n <node_limit> -b <memory_limit_MB> -f <memsave_fraction> -x <suffix> -o <output_dir>"
+}
+
+suffix=".lp.gz"
+killPolicy=""
+nodes=10000
+mem=100
+saveFac=0.8
+outDir=/tmp/bench_memsave
+
+while getopts ":hd:s:k:n:b:f:x:o:" arg; do
+  case $arg in
+    h)
+      usage
+      exit 0
+      ;;
+    d)
+      data=${OPTARG%/}
+      ;;
+    s)
+      searchPolicy=${OPTARG}
+      ;;
+    k)
+      killPolicy=${OPTARG}
+      ;;
+    n)
+      nodes=${OPTARG}
+      ;;
+    b)
+      mem=${OPTARG}
+      ;;
+    f)
+      saveFac=${OPTARG}
+      ;;
+    x)
+      suffix=${OPTARG}
+      ;;
+    o)
+      outDir=${OPTARG%/}
+      ;;
+    :)
+      echo "ERROR: -${OPTARG} requires an argument"
+      usage
+      exit 1
+      ;;
+    ?)
+      echo "ERROR: unknown option -${OPTARG}"
+      usage
+      exit 1
+      ;;
+  esac
+done
+
+if [ -z $data ] || [ -z $searchPolicy ]; then
+  usage
+  exit 1
+fi
+if ! [ -d $outDir ]; then mkdir -p $outDir; fi
+
+pruner=""
+if [ -n "$killPolicy" ]; then
+  pruner="--nodepru policy $killPolicy"
+fi
+
+# value of a statistics line "<name> : <value>" of a log
+stat() {
+  grep -m1 "^ *$1 *:" $2 | sed 's/^[^:]*: *//' | awk '{print $1}'
+}
+
+printf "%-30s %-8s %8s %10s %8s %16s %16s %10s\n" problem memsave nodes memsavesel time primal dual gap
+for file in `ls dat/$data`; do
+  base=`sed "s/$suffix//g" <<< $file`
+  for prio in 200000 0; do
+    set=$outDir/memsave$prio.set
+    cp scip.set $set
+    echo "nodeselection/policy/memsavepriority = $prio" >> $set
+    # memory saving mode starts when the memory used exceeds this fraction of the memory limit
+    echo "memory/savefac = $saveFac" >> $set
+    log=$outDir/$base.memsave$prio.log
+    bin/scipdagger -s $set -f dat/$data/$file -n $nodes -m $mem --nodesel policy $searchPolicy $pruner &> $log || true
+    sels=`stat "memsave selects" $log`
+    printf "%-30s %-8s %8s %10s %8s %16s %16s %10s\n" $base $prio "`stat "Solving Nodes" $log`" "${sels:-0}" \
+      "`stat "Solving Time (sec)" $log`" "`stat "Primal Bound" $log`" "`stat "Dual Bound" $log`" "`stat "Gap" $log`"
+  done
+done
@@ -0,0 +1,145 @@
+"""Fit a calibration of pruning policy scores to pruning probabilities on a trajectory.
+
+The trajectory is in LIBSVM format as written by the oracle and dagger pruners (label 1: prune), e.g. the output of
+trjstore.py cat; weights are read from <trj>.weight if it exists. The policy is a LIBLINEAR model. The calibration
+file is read by the policy and dagger pruners (nodepruning/<name>/calibfname):
+
+   platt <a> <b>                 probability 1 / (1 + exp(a * score + b))
+   isotonic <n>                  followed by n lines <score> <probability> with increasing scores
+
+Usage:
+   calibrate.py <trj> <model> <out> [--method platt|isotonic]
+"""
+from __future__ import print_function
+import argparse
+import math
+import os
+
+HEADERSIZE_LIBSVM = 6
+
+
+def read_model(fname):
+   with open(fname, 'r') as fin:
+      lines = fin.readlines()[HEADERSIZE_LIBSVM:]
+   return [float(line) for line in lines if line.strip()]
+
+
+def read_scores(fname, weights):
+   """returns the policy scores, labels and example weights of the trajectory"""
+   scores, labels = [], []
+   with open(fname, 'r') as fin:
+      for line in fin:
+         fields = line.split()
+         if not fields:
+            continue
+         score = 0.0
+         for field in fields[1:]:
+            idx, val = field.split(':')
+            idx = int(idx) - 1
+            # examples beyond the model are scored 0 like in SCIPcalcNodeScore
+            if idx >= len(weights):
+               score = 0.0
+               break
+            score += weights[idx] * float(val)
+         scores.append(score)
+         labels.append(1 if int(float(fields[0])) == 1 else 0)
+   ws = [1.0] * len(scores)
+   if os.path.exists(fname + '.weight'):
+      with open(fname + '.weight', 'r') as fin:
+         ws = [float(line) for line in fin if line.strip()]
+      assert len(ws) == len(scores)
+   return scores, labels, ws
+
+
+def fit_platt(scores, labels, ws, maxiter=100):
+   """Platt's method with regularized targets, fitted by Newton's method with backtracking"""
+   npos = sum(w for y, w in zip(labels, ws) if y == 1)
+   nneg = sum(w for y, w in zip(labels, ws) if y == 0)
+   hi = (npos + 1.0) / (npos + 2.0)
+   lo = 1.0 / (nneg + 2.0)
+   targets = [hi if y == 1 else lo for y in labels]
+
+   def loss(a, b):
+      f = 0.0
+      for s, t, w in zip(scores, targets, ws):
+         z = a * s + b
+         # -t log p - (1 - t) log(1 - p) with p = 1 / (1 + exp(z))
+         if z >= 0:
+            f += w * (t * z + math.log1p(math.exp(-z)))
+         else:
+            f += w * ((t - 1) * z + math.log1p(math.exp(z)))
+      return f
+
+   a, b = 0.0, math.log((nneg + 1.0) / (npos + 1.0))
+   f = loss(a, b)
+   for _ in range(maxiter):
+      h11 = h22 = 1e-12
+      h21 = g1 = g2 = 0.0
+      for s, t, w in zip(scores, targets, ws):
+         z = a * s + b
+         p = 1.0 / (1.0 + math.exp(z)) if z >= 0 else math.exp(-z) / (1.0 + math.exp(-z))
+         d1 = w * (t - p)
+         d2 = w * p * (1.0 - p)
+         g1 += s * d1
+         g2 += d1
+         h11 += s * s * d2
+         h22 += d2
+         h21 += s * d2
+      if abs(g1) < 1e-5 and abs(g2) < 1e-5:
+         break
+      det = h11 * h22 - h21 * h21
+      da = -(h22 * g1 - h21 * g2) / det
+      db = -(-h21 * g1 + h11 * g2) / det
+      step = 1.0
+      while step >= 1e-10:
+         fnew = loss(a + step * da, b + step * db)
+         if fnew < f + 1e-4 * step * (g1 * da + g2 * db):
+            break
+         step /= 2.0
+      if step < 1e-10:
+         break
+      a, b, f = a + step * da, b + step * db, fnew
+   return a, b
+
+
+def fit_isotonic(scores, labels, ws):
+   """pool adjacent violators on examples sorted by score; returns (mean score, probability) of the blocks"""
+   # examples with equal scores form one block from the start, so block scores are increasing
+   blocks = []
+   for s, y, w in sorted(zip(scores, labels, ws)):
+      if blocks and blocks[-1][0] / blocks[-1][2] == s:
+         blocks[-1] = [blocks[-1][0] + s * w, blocks[-1][1] + y * w, blocks[-1][2] + w]
+      else:
+         blocks.append([s * w, y * w, w])
+   pooled = []
+   for block in blocks:
+      pooled.append(block)
+      while len(pooled) > 1 and pooled[-2][1] / pooled[-2][2] >= pooled[-1][1] / pooled[-1][2]:
+         last = pooled.pop()
+         pooled[-1] = [pooled[-1][0] + last[0], pooled[-1][1] + last[1], pooled[-1][2] + last[2]]
+   return [(s / w, y / w) for s, y, w in pooled]
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='fit a calibration of pruning policy scores')
+   parser.add_argument('trj', help='pruning trajectory in LIBSVM format')
+   parser.add_argument('model', help='LIBLINEAR model of the pruning policy')
+   parser.add_argument('out', help='calibration file to write')
+   parser.add_argument('--method', choices=['platt', 'isotonic'], default='platt')
+   args = parser.parse_args()
+
+   scores, labels, ws = read_scores(args.trj, read_model(args.model))
+   if not scores:
+      raise SystemExit('empty trajectory %s' % args.trj)
+
+   with open(args.out, 'w') as fout:
+      if args.method == 'platt':
+         a, b = fit_platt(scores, labels, ws)
+         fout.write('platt %.10g %.10g\n' % (a, b))
+         print('platt calibration a=%g b=%g of %d examples' % (a, b, len(scores)))
+      else:
+         points = fit_isotonic(scores, labels, ws)
+         fout.write('isotonic %d\n' % len(points))
+         for s, p in points:
+            fout.write('%.10g %.10g\n' % (s, p))
+         print('isotonic calibration with %d points of %d examples' % (len(points), len(scores)))
@@ -0,0 +1,70 @@
+"""Quantize a perceptron with one hidden layer of rectified linear units into a policy file of the node selectors and
+pruners.
+
+The perceptron is a JSON file {"w1": [[...] per hidden unit], "b1": [...], "w2": [...], "b2": <float>} over the
+features of a node, i.e. LIBSVM feature index k of the trajectory is input (k - 1) % featsize. The range of each input
+is taken from the pruning trajectory the perceptron was trained on; inputs are quantized to [-127,127] and the hidden
+weights, with the input factors folded in, to 8 bit integers per hidden unit. Search trajectories hold differences of
+two nodes, whose ranges are not those of the nodes and which a perceptron does not score as the difference of their
+scores, so they are rejected; the node selectors do not accept perceptrons either. The policy file is
+
+   mlp <ninputs> <nhidden> <b2>
+   <factor_1> ... <factor_ninputs>
+   <scale> <b1> <w2> <q_1> ... <q_ninputs>        one line per hidden unit
+
+Usage:
+   mlp2policy.py <mlp> <trj> <out> --featsize <n>
+"""
+from __future__ import print_function
+import argparse
+import json
+
+
+def input_ranges(fname, featsize):
+   """largest absolute value of each input over the pruning trajectory"""
+   ranges = [0.0] * featsize
+   with open(fname, 'r') as fin:
+      for line in fin:
+         blocks = set()
+         for field in line.split()[1:]:
+            idx, val = field.split(':')
+            blocks.add((int(idx) - 1) // featsize)
+            i = (int(idx) - 1) % featsize
+            ranges[i] = max(ranges[i], abs(float(val)))
+         # an example of a pruning trajectory is one node, i.e. its features lie in one block of featsize indices
+         if len(blocks) > 1:
+            raise SystemExit('example with features of several nodes in %s: perceptrons are trained on pruning '
+               'trajectories, not on search trajectories of differences of nodes' % fname)
+   return ranges
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='quantize a perceptron to an mlp policy')
+   parser.add_argument('mlp', help='JSON file of the perceptron')
+   parser.add_argument('trj', help='pruning trajectory in LIBSVM format giving the ranges of the inputs')
+   parser.add_argument('out', help='policy file to write')
+   parser.add_argument('--featsize', type=int, required=True, help='number of features of a node (16 for kill, more with instfeats, branchfeats or pathfeats)')
+   args = parser.parse_args()
+
+   with open(args.mlp, 'r') as fin:
+      mlp = json.load(fin)
+   w1, b1, w2, b2 = mlp['w1'], mlp['b1'], mlp['w2'], float(mlp['b2'])
+   assert len(w1) == len(b1) == len(w2)
+   assert all(len(row) == args.featsize for row in w1)
+
+   # round(factor * x) is in [-127,127] on the trajectory; constant inputs are passed unscaled
+   factors = [127.0 / r if r > 0.0 else 1.0 for r in input_ranges(args.trj, args.featsize)]
+
+   maxerr = 0.0
+   with open(args.out, 'w') as fout:
+      fout.write('mlp %d %d %.10g\n' % (args.featsize, len(w1), b2))
+      fout.write(' '.join('%.10g' % f for f in factors) + '\n')
+      for row, bias, out in zip(w1, b1, w2):
+         folded = [w / f for w, f in zip(row, factors)]
+         scale = max(abs(w) for w in folded) / 127.0
+         if scale == 0.0:
+            scale = 1.0
+         quantized = [int(round(w / scale)) for w in folded]
+         maxerr = max([maxerr] + [abs(q * scale - w) * f for q, w, f in zip(quantized, folded, factors)])
+         fout.write('%.10g %.10g %.10g %s\n' % (scale, bias, out, ' '.join(str(q) for q in quantized)))
+   print('wrote perceptron with %d hidden units to %s, largest weight error %g' % (len(w1), args.out, maxerr))
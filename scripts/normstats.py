@@ -0,0 +1,164 @@
+"""Normalization statistics of the features of a trajectory, computed in one streaming pass.
+
+For each feature bucket (LIBSVM index k is feature (k - 1) % featsize of bucket (k - 1) // featsize) and feature, the
+mean and the variance are accumulated by Welford's method. A feature is then clipped to the mean plus or minus
+--clip standard deviations (within the observed range), centered and divided by its standard deviation. Search
+trajectories hold differences of two nodes (--pairwise); their features are only scaled, since centering and
+clipping do not commute with differences. Buckets without examples get the statistics pooled over all buckets.
+
+The statistics file is read by the node selectors and pruners as the beginning of a policy file:
+
+   normalize <featsize> <nbuckets>
+   <mean> <scale> <lower> <upper>                  one line per bucket and feature
+
+Usage:
+   normstats.py stats <trj> <stats> --featsize <n> [--pairwise] [--clip <c>]
+      computes the statistics of a trajectory, e.g. the output of trjstore.py cat
+   normstats.py apply <trj> <stats> <out>
+      writes the normalized trajectory (and its weights) for training
+   normstats.py embed <stats> <model> <out>
+      writes the policy file of a model trained on the normalized trajectory; depth anchor policies are rejected
+"""
+from __future__ import print_function
+import argparse
+import math
+import shutil
+import os
+
+NOCLIP = 1e20
+
+
+class Moments(object):
+   def __init__(self):
+      self.n = 0
+      self.mean = 0.0
+      self.m2 = 0.0
+      self.lo = float('inf')
+      self.hi = float('-inf')
+
+   def add(self, val):
+      self.n += 1
+      delta = val - self.mean
+      self.mean += delta / self.n
+      self.m2 += delta * (val - self.mean)
+      self.lo = min(self.lo, val)
+      self.hi = max(self.hi, val)
+
+   def merge(self, other):
+      if other.n == 0:
+         return
+      n = self.n + other.n
+      delta = other.mean - self.mean
+      self.mean += delta * other.n / n
+      self.m2 += other.m2 + delta * delta * self.n * other.n / n
+      self.n = n
+      self.lo = min(self.lo, other.lo)
+      self.hi = max(self.hi, other.hi)
+
+   def stats(self, pairwise, clip):
+      """returns mean, scale, lower and upper bound"""
+      std = math.sqrt(self.m2 / self.n) if self.n > 0 else 0.0
+      scale = 1.0 / std if std > 0.0 else 1.0
+      if pairwise:
+         return 0.0, scale, -NOCLIP, NOCLIP
+      if self.n == 0:
+         return 0.0, 1.0, -NOCLIP, NOCLIP
+      return (self.mean, scale, max(self.lo, self.mean - clip * std), min(self.hi, self.mean + clip * std))
+
+
+def read_stats(fname):
+   with open(fname, 'r') as fin:
+      tag, featsize, nbuckets = fin.readline().split()
+      assert tag == 'normalize'
+      stats = [tuple(float(v) for v in fin.readline().split()) for _ in range(int(featsize) * int(nbuckets))]
+   return int(featsize), int(nbuckets), stats
+
+
+def stats(args):
+   moments = {}
+   with open(args.trj, 'r') as fin:
+      for line in fin:
+         for field in line.split()[1:]:
+            idx, val = field.split(':')
+            idx = int(idx) - 1
+            key = (idx // args.featsize, idx % args.featsize)
+            if key not in moments:
+               moments[key] = Moments()
+            moments[key].add(float(val))
+   if not moments:
+      raise SystemExit('empty trajectory %s' % args.trj)
+
+   nbuckets = max(b for b, _ in moments) + 1
+   pooled = [Moments() for _ in range(args.featsize)]
+   for (_, i), m in moments.items():
+      pooled[i].merge(m)
+
+   with open(args.stats, 'w') as fout:
+      fout.write('normalize %d %d\n' % (args.featsize, nbuckets))
+      for b in range(nbuckets):
+         for i in range(args.featsize):
+            m = moments.get((b, i), pooled[i])
+            fout.write('%.10g %.10g %.10g %.10g\n' % m.stats(args.pairwise, args.clip))
+   print('wrote statistics of %d features in %d buckets to %s' % (args.featsize, nbuckets, args.stats))
+
+
+def apply(args):
+   featsize, nbuckets, table = read_stats(args.stats)
+   with open(args.trj, 'r') as fin, open(args.out, 'w') as fout:
+      for line in fin:
+         fields = line.split()
+         if not fields:
+            continue
+         out = [fields[0]]
+         for field in fields[1:]:
+            idx, val = field.split(':')
+            k = int(idx) - 1
+            mean, scale, lo, hi = table[min(k // featsize, nbuckets - 1) * featsize + k % featsize]
+            out.append('%s:%f' % (idx, (min(max(float(val), lo), hi) - mean) * scale))
+         fout.write(' '.join(out) + '\n')
+   if os.path.exists(args.trj + '.weight'):
+      shutil.copyfile(args.trj + '.weight', args.out + '.weight')
+
+
+def embed(args):
+   with open(args.model, 'r') as fin:
+      tag = fin.readline().split()[:1]
+   if tag == ['anchor']:
+      raise SystemExit('depth anchor policy %s interpolates at the raw relative depth and cannot be normalized'
+                       % args.model)
+   with open(args.out, 'w') as fout:
+      for fname in (args.stats, args.model):
+         with open(fname, 'r') as fin:
+            shutil.copyfileobj(fin, fout)
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='normalization statistics of trajectory features')
+   subparsers = parser.add_subparsers(dest='command')
+
+   parser_stats = subparsers.add_parser('stats', help='compute the statistics of a trajectory')
+   parser_stats.add_argument('trj')
+   parser_stats.add_argument('stats')
+   parser_stats.add_argument('--featsize', type=int, required=True, help='number of features of a node (18 for search, 16 for kill)')
+   parser_stats.add_argument('--pairwise', action='store_true', help='examples are differences of two nodes')
+   parser_stats.add_argument('--clip', type=float, default=4.0, help='clip features at this many standard deviations')
+
+   parser_apply = subparsers.add_parser('apply', help='normalize a trajectory')
+   parser_apply.add_argument('trj')
+   parser_apply.add_argument('stats')
+   parser_apply.add_argument('out')
+
+   parser_embed = subparsers.add_parser('embed', help='prepend the statistics to a model')
+   parser_embed.add_argument('stats')
+   parser_embed.add_argument('model')
+   parser_embed.add_argument('out')
+
+   args = parser.parse_args()
+   if args.command == 'stats':
+      stats(args)
+   elif args.command == 'apply':
+      apply(args)
+   elif args.command == 'embed':
+      embed(args)
+   else:
+      parser.print_help()
@@ -0,0 +1,44 @@
+"""Add the policies of a dataset to the index of a policy directory, with the mean fingerprint of its problems.
+
+The fingerprints are printed by bin/scipdagger -f <problem> --fingerprint. The index is read by
+bin/scipdagger --poldir <dir>, which selects the policies of the entry nearest to the fingerprint of the problem, after
+dividing each fingerprint entry by its standard deviation over the index entries:
+
+   <search policy> <kill policy> <fingerprint>     one line per dataset, policies relative to the directory or -
+
+Usage:
+   polindex.py <poldir> <search policy> <kill policy> <problem> [<problem> ...]
+"""
+from __future__ import print_function
+import argparse
+import os
+import subprocess
+
+INDEX = 'index'
+TAG = 'instance fingerprint:'
+
+
+def fingerprint(binary, problem):
+   out = subprocess.check_output([binary, '-f', problem, '--fingerprint']).decode()
+   for line in out.splitlines():
+      if line.startswith(TAG):
+         return [float(v) for v in line[len(TAG):].split()]
+   raise SystemExit('no fingerprint of problem %s' % problem)
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='add the policies of a dataset to a policy index')
+   parser.add_argument('poldir', help='policy directory')
+   parser.add_argument('search', help='search policy relative to the directory, or -')
+   parser.add_argument('kill', help='kill policy relative to the directory, or -')
+   parser.add_argument('problems', nargs='+', help='problems of the dataset')
+   parser.add_argument('--binary', default='bin/scipdagger', help='scipdagger binary')
+   args = parser.parse_args()
+
+   prints = [fingerprint(args.binary, p) for p in args.problems]
+   mean = [sum(f[i] for f in prints) / len(prints) for i in range(len(prints[0]))]
+
+   with open(os.path.join(args.poldir, INDEX), 'a') as fout:
+      fout.write('%s %s %s\n' % (args.search, args.kill, ' '.join('%.6g' % v for v in mean)))
+   print('added %s and %s with the mean fingerprint of %d problems to %s'
+      % (args.search, args.kill, len(prints), os.path.join(args.poldir, INDEX)))
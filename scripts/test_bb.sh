@@ -2,14 +2,16 @@
 set -e
 
 usage() {
-  echo "Usage: $0 -d <data_path_under_dat> -s <search_policy> -k <kill_policy> -e <experiment> -x <suffix> -m <problem> -r <restriced_level> -g <dagger>"
+  echo "Usage: $0 -d <data_path_under_dat> -s <search_policy> -k <kill_policy> -P <policy_dir> -e <experiment> -x <suffix> -m <problem> -r <restriced_level> -g <dagger> -n <node_limit> -b <memory_limit_MB>"
 }
 
 suffix=".lp.gz"
 freq=1
 dagger=0
+limits=""
+polDir=""
 
-while getopts ":hd:s:k:e:x:m:r:g:" arg; do
+while getopts ":hd:s:k:P:e:x:m:r:g:n:b:" arg; do
   case $arg in
     h)
       usage
@@ -27,6 +29,10 @@ while getopts ":hd:s:k:e:x:m:r:g:" arg; do
       killPolicy=${OPTARG}
       echo "kill policy: $killPolicy"
       ;;
+    P)
+      polDir=${OPTARG%/}
+      echo "policy directory: $polDir"
+      ;;
     e)
       experiment=${OPTARG}
       echo "experiment: $experiment"
@@ -47,6 +53,14 @@ while getopts ":hd:s:k:e:x:m:r:g:" arg; do
       dagger=${OPTARG}
       echo "run dagger: $dagger"
       ;;
+    n)
+      limits="$limits -n ${OPTARG}"
+      echo "node limit: ${OPTARG}"
+      ;;
+    b)
+      limits="$limits -m ${OPTARG}"
+      echo "memory limit: ${OPTARG} MB"
+      ;;
     :)
       echo "ERROR: -${OPTARG} requires an argument"
       usage
@@ -60,6 +74,10 @@ while getopts ":hd:s:k:e:x:m:r:g:" arg; do
   esac
 done
 
+if [[ -n $polDir ]]; then
+  limits="$limits --poldir $polDir"
+fi
+
 resultDir=/fs/clip-scratch/hhe/scip-dagger/result
 dir=dat/$data
 if ! [ -d $resultDir/$data/$experiment ]; then
@@ -69,10 +87,10 @@ for file in `ls $dir`; do
   base=`sed "s/$suffix//g" <<< $file`
   echo $base
   if [[ $dagger -eq 0 ]]; then
-    bin/scipdagger -r $freq -s scip.set -f $dir/$file --nodesel policy $searchPolicy --nodepru policy $killPolicy &> $resultDir/$data/$experiment/$base.log
+    bin/scipdagger -r $freq $limits -s scip.set -f $dir/$file --nodesel policy $searchPolicy --nodepru policy $killPolicy &> $resultDir/$data/$experiment/$base.log
   else
     sol=solution/$data/$base.sol
-    bin/scipdagger -r $freq -s scip.set -f $dir/$file -o $sol --nodesel dagger $searchPolicy --nodepru dagger $killPolicy &> $resultDir/$data/$experiment/$base.log
+    bin/scipdagger -r $freq $limits -s scip.set -f $dir/$file -o $sol --nodesel dagger $searchPolicy --nodepru dagger $killPolicy &> $resultDir/$data/$experiment/$base.log
   fi
 done
 
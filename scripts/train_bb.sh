@@ -3,14 +3,16 @@
 set -e
 
 usage() {
-  echo "Usage: $0 -d <data_path_under_dat> -x <suffix> -p <num_passes> -n <num_per_iter> -c <svm_c> -w <svm_w> -e <experiment> -m <problem> -r <restriced_level>"
+  echo "Usage: $0 -d <data_path_under_dat> -x <suffix> -p <num_passes> -n <num_per_iter> -c <svm_c> -w <svm_w> -e <experiment> -m <problem> -r <restriced_level> -q <dedup_quant>"
 }
 
 suffix=".lp.gz"
 problem="general"
 freq=1
+# kill examples are merged across shards after rounding their features to multiples of dedup (0: no merging)
+dedup=0.001
 
-while getopts ":hd:p:n:c:e:w:tx:m:r:" arg; do
+while getopts ":hd:p:n:c:e:w:tx:m:r:q:" arg; do
   case $arg in
     h)
       usage
@@ -52,6 +54,10 @@ while getopts ":hd:p:n:c:e:w:tx:m:r:" arg; do
       freq=${OPTARG}
       echo "restriced level: $freq"
       ;;
+    q)
+      dedup=${OPTARG}
+      echo "dedup quantization step: $dedup"
+      ;;
     :)
       echo "ERROR: -${OPTARG} requires an argument"
       usage
@@ -75,13 +81,17 @@ fi
 
 trjDir=$scratch/hhe/scip-dagger/trj/$data/$experiment
 if ! [ -d $trjDir ]; then mkdir -p $trjDir; fi
+# Oracle trajectories are deterministic given the problem, solution, settings and binary;
+# they are cached across passes and experiments
+cacheDir=$scratch/hhe/scip-dagger/cache/oracle
+if ! [ -d $cacheDir ]; then mkdir -p $cacheDir; fi
 searchTrj=$trjDir/"search.trj"
 killTrj=$trjDir/"kill.trj"
-# We need to append to these trj
-if [ -e $searchTrj ]; then rm $searchTrj; echo "rm $searchTrj"; fi
-if [ -e $killTrj ]; then rm $killTrj; echo "rm $killTrj"; fi
-if [ -e $searchTrj.weight ]; then rm $searchTrj.weight; fi
-if [ -e $killTrj.weight ]; then rm $killTrj.weight; fi
+# Trajectories of each instance and iteration are kept as shards of an append-only store;
+# the training files are streamed from the store before each round of training
+searchStore=$trjDir/store/search
+killStore=$trjDir/store/kill
+if [ -d $trjDir/store ]; then rm -r $trjDir/store; echo "rm $trjDir/store"; fi
 
 policyDir=policy/$data/$experiment
 if ! [ -d $policyDir ]; then mkdir -p $policyDir; fi
@@ -103,39 +113,51 @@ for i in `seq 1 $numPasses`; do
     if [ -z $searchPolicy ]; then
       # First round, no policy yet
       echo "Gathering first iteration trajectory data"
-      bin/scipdagger -r $freq -s scip.set -f $prob -o $sol --nodesel oracle --nodeseltrj $searchTrjIter --nodepru oracle --nodeprutrj $killTrjIter
-      cat $searchTrjIter >> $searchTrj
-      cat $searchTrjIter.weight >> $searchTrj.weight
-      cat $killTrjIter >> $killTrj
-      cat $killTrjIter.weight >> $killTrj.weight
+      key=`(cat $prob $sol scip.set bin/scipdagger; echo "-r $freq") | md5sum | cut -d' ' -f1`
+      cached=$cacheDir/$key
+      if [ -e $cached.done ]; then
+        echo "Using cached oracle trajectory $cached"
+        cp $cached.search.trj $searchTrjIter
+        cp $cached.search.trj.weight $searchTrjIter.weight
+        cp $cached.kill.trj $killTrjIter
+        cp $cached.kill.trj.weight $killTrjIter.weight
+      else
+        bin/scipdagger -r $freq -s scip.set -f $prob -o $sol --nodesel oracle --nodeseltrj $searchTrjIter --nodepru oracle --nodeprutrj $killTrjIter
+        cp $searchTrjIter $cached.search.trj
+        cp $searchTrjIter.weight $cached.search.trj.weight
+        cp $killTrjIter $cached.kill.trj
+        cp $killTrjIter.weight $cached.kill.trj.weight
+        # mark the entry complete only after all files are in place
+        touch $cached.done
+      fi
     else
       # Search with policy 
       echo "Gathering trajectory data with $policy"
       bin/scipdagger -r $freq -s scip.set -f $prob -o $sol --nodesel dagger $searchPolicy --nodeseltrj $searchTrjIter --nodepru dagger $killPolicy --nodeprutrj $killTrjIter
-      cat $searchTrjIter >> $searchTrj
-      cat $searchTrjIter.weight >> $searchTrj.weight
-      cat $killTrjIter >> $killTrj
-      cat $killTrjIter.weight >> $killTrj.weight
     fi
-    rm $killTrjIter $searchTrjIter $killTrjIter.weight $searchTrjIter.weight
+    python scripts/trjstore.py add $searchStore $searchTrjIter --iter $numPolicy --instance $base
+    python scripts/trjstore.py add $killStore $killTrjIter --iter $numPolicy --instance $base
 
     # Learn a policy after a few examples
     if [ `echo "$num % $numPerIter" | bc` -eq 0 ]; then
       if ! [ -d $scratch/$data/$experiment ]; then mkdir -p $scratch/$data/$experiment; fi
+      python scripts/trjstore.py cat $searchStore $searchTrj
+      if [ `echo "$dedup > 0" | bc` -eq 1 ]; then
+        python scripts/trjstore.py cat $killStore $killTrj --dedup $dedup
+      else
+        python scripts/trjstore.py cat $killStore $killTrj
+      fi
 
       searchPolicy=$policyDir/searchPolicy.$numPolicy
-      echo "c = $svmc/$(avg $searchTrj.weight)"
-      c=$(echo "scale=6; $svmc/$(avg $searchTrj.weight)" | bc)
-      echo "Training search policy $numPolicy with svm c=$c"
-      bin/train-w -c $c -W $searchTrj.weight $searchTrj $searchPolicy
+      # example weights are normalized to mean one by the plugins, so c needs no rescaling
+      echo "Training search policy $numPolicy with svm c=$svmc"
+      bin/train-w -c $svmc -W $searchTrj.weight $searchTrj $searchPolicy
       bin/predict $searchTrj $searchPolicy $scratch/$data/$experiment/pred
 
       killPolicy=$policyDir/killPolicy.$numPolicy
-      echo "c = $svmc/$(avg $killTrj.weight)"
-      c=$(echo "scale=6; $svmc/$(avg $killTrj.weight)" | bc)
       if [ $numPolicy == 0 ]; then w=1; else w=$svmw; fi
-      echo "Training node kill policy $numPolicy with svm c=$c and w-1=$w"
-      bin/train-w -c $c -w-1 $w -W $killTrj.weight $killTrj $killPolicy
+      echo "Training node kill policy $numPolicy with svm c=$svmc and w-1=$w"
+      bin/train-w -c $svmc -w-1 $w -W $killTrj.weight $killTrj $killPolicy
       bin/predict $killTrj $killPolicy $scratch/$data/$experiment/pred
 
       searchPolicy=$policyDir/searchPolicy.$numPolicy
@@ -146,5 +168,5 @@ for i in `seq 1 $numPasses`; do
   done
 done
 
-rm $trjDir/*
+rm -r $trjDir/*
 
@@ -0,0 +1,198 @@
+"""Append-only sharded store of trajectories written by the oracle and dagger plugins.
+
+Each shard is one trajectory (LIBSVM examples plus a .weight file) of one instance in
+one DAgger iteration. Shards are never rewritten; a MANIFEST file lists them, one per line:
+
+   <seq> <iter> <instance> <nexamples> <shard file>
+
+Usage:
+   trjstore.py add <store> <trj> --iter <i> --instance <name>
+      moves <trj> and <trj>.weight into the store
+   trjstore.py cat <store> <out> [--iter <a>:<b>] [--instance <regex>] [--bucket <b1,b2,..> --featsize <n>] [--dedup <q>]
+      streams the selected shards into <out> and <out>.weight; with --dedup, features are rounded to multiples of q
+      and duplicate examples across all selected shards are merged into the first one, summing up their weights
+"""
+from __future__ import print_function
+import argparse
+import collections
+import mmap
+import os
+import re
+import shutil
+import sys
+
+MANIFEST = 'MANIFEST'
+
+
+def read_manifest(store):
+   shards = []
+   path = os.path.join(store, MANIFEST)
+   if not os.path.exists(path):
+      return shards
+   with open(path, 'r') as fin:
+      for line in fin:
+         seq, it, instance, nexamples, fname = line.split()
+         shards.append({'seq': int(seq), 'iter': int(it), 'instance': instance,
+            'nexamples': int(nexamples), 'file': os.path.join(store, fname)})
+   return shards
+
+
+def open_mmap(fname):
+   """returns a read-only map of fname for sequential reading, or None if it is empty"""
+   f = open(fname, 'rb')
+   if os.fstat(f.fileno()).st_size == 0:
+      f.close()
+      return None
+   mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+   f.close()
+   if hasattr(mm, 'madvise'):
+      mm.madvise(mmap.MADV_SEQUENTIAL)
+   return mm
+
+
+def count_lines(fname):
+   mm = open_mmap(fname)
+   if mm is None:
+      return 0
+   n = 0
+   pos = mm.find(b'\n')
+   while pos != -1:
+      n += 1
+      pos = mm.find(b'\n', pos + 1)
+   mm.close()
+   return n
+
+
+def add(args):
+   if not os.path.isdir(args.store):
+      os.makedirs(args.store)
+   seq = len(read_manifest(args.store))
+   fname = '%06d.%d.%s.trj' % (seq, args.iter, args.instance)
+   nexamples = count_lines(args.trj)
+   shutil.move(args.trj, os.path.join(args.store, fname))
+   shutil.move(args.trj + '.weight', os.path.join(args.store, fname + '.weight'))
+   # the shard is complete before it is listed
+   with open(os.path.join(args.store, MANIFEST), 'a') as fout:
+      fout.write('%d %d %s %d %s\n' % (seq, args.iter, args.instance, nexamples, fname))
+
+
+def example_bucket(line, featsize):
+   """feature offset bucket of an example, i.e. of its smallest feature index"""
+   fields = line.split(None, 2)
+   if len(fields) < 2:
+      return -1
+   return (int(fields[1].split(b':')[0]) - 1) // featsize
+
+
+def dedup_key(line, quant):
+   """label and quantized features of an example, as the key of its duplicates and the line written for them"""
+   fields = line.split()
+   if not fields:
+      return None, None
+   feats = []
+   for field in fields[1:]:
+      i, v = field.split(b':')
+      feats.append((int(i), int(round(float(v) / quant))))
+   key = (fields[0], tuple(feats))
+   out = fields[0] + b' ' + b''.join(b'%d:%f ' % (i, quant * q) for i, q in feats) + b'\n'
+   return key, out
+
+
+def cat(args):
+   lo, hi = None, None
+   if args.iter is not None:
+      lo, hi = args.iter.split(':')
+      lo = int(lo) if lo else None
+      hi = int(hi) if hi else None
+   instance = re.compile(args.instance) if args.instance is not None else None
+   buckets = set(int(b) for b in args.bucket.split(',')) if args.bucket is not None else None
+   if buckets is not None and args.featsize is None:
+      sys.exit('--bucket needs --featsize')
+
+   if args.dedup is not None and args.dedup <= 0.0:
+      sys.exit('--dedup needs a positive quantization step')
+   # merged examples are kept in memory until all shards are read, in the order of their first occurrence
+   merged = collections.OrderedDict() if args.dedup is not None else None
+
+   nshards = 0
+   nexamples = 0
+   nmerged = 0
+   with open(args.out, 'wb') as fout, open(args.out + '.weight', 'wb') as wout:
+      for shard in read_manifest(args.store):
+         if lo is not None and shard['iter'] < lo:
+            continue
+         if hi is not None and shard['iter'] >= hi:
+            continue
+         if instance is not None and not instance.search(shard['instance']):
+            continue
+         mm = open_mmap(shard['file'])
+         if mm is None:
+            continue
+         wfile = shard['file'] + '.weight'
+         wmm = open_mmap(wfile) if os.path.exists(wfile) else None
+         if wmm is None:
+            mm.close()
+            sys.exit('shard %s has examples but its weight file %s is missing or empty' % (shard['file'], wfile))
+         nshards += 1
+         if buckets is None and merged is None:
+            fout.write(mm)
+            wout.write(wmm)
+            nexamples += shard['nexamples']
+         else:
+            line = mm.readline()
+            while line:
+               weight = wmm.readline()
+               if not weight:
+                  sys.exit('weight file of shard %s has fewer lines than the shard' % shard['file'])
+               if buckets is None or example_bucket(line, args.featsize) in buckets:
+                  if merged is None:
+                     fout.write(line)
+                     wout.write(weight)
+                     nexamples += 1
+                  else:
+                     key, out = dedup_key(line, args.dedup)
+                     if key in merged:
+                        merged[key][1] += float(weight)
+                        nmerged += 1
+                     elif key is not None:
+                        merged[key] = [out, float(weight)]
+               line = mm.readline()
+         mm.close()
+         wmm.close()
+      if merged is not None:
+         for out, weight in merged.values():
+            fout.write(out)
+            wout.write(b'%f\n' % weight)
+         nexamples = len(merged)
+   if merged is not None:
+      print('merged %d duplicate examples' % nmerged)
+   print('wrote %d examples of %d shards to %s' % (nexamples, nshards, args.out))
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='sharded trajectory store')
+   subparsers = parser.add_subparsers(dest='command')
+
+   parser_add = subparsers.add_parser('add', help='move a trajectory into the store')
+   parser_add.add_argument('store')
+   parser_add.add_argument('trj')
+   parser_add.add_argument('--iter', type=int, required=True, help='DAgger iteration')
+   parser_add.add_argument('--instance', required=True, help='instance name')
+
+   parser_cat = subparsers.add_parser('cat', help='stream selected shards into one trajectory')
+   parser_cat.add_argument('store')
+   parser_cat.add_argument('out')
+   parser_cat.add_argument('--iter', help='half-open range of iterations <a>:<b>, either end may be empty')
+   parser_cat.add_argument('--instance', help='regular expression on instance names')
+   parser_cat.add_argument('--bucket', help='comma-separated feature offset buckets')
+   parser_cat.add_argument('--featsize', type=int, help='number of features of a node (18 for search, 16 for kill)')
+   parser_cat.add_argument('--dedup', type=float,
+      help='merge duplicate examples across shards after rounding features to multiples of this step, summing weights')
+
+   args = parser.parse_args()
+   if args.command == 'add':
+      add(args)
+   elif args.command == 'cat':
+      cat(args)
+   else:
+      parser.print_help()
@@ -0,0 +1,60 @@
+"""Convert a gradient-boosted tree ensemble dumped by xgboost into a policy file of the node selectors and pruners.
+
+The input is the JSON dump of a booster (booster.dump_model(<dump>, dump_format='json')) trained on the LIBSVM
+pruning trajectories, so that feature f<k> is the LIBSVM feature index k. Search trajectories hold differences of two
+nodes, which a tree ensemble does not score as the difference of their scores, so the node selectors reject the
+converted policy; use it as a kill policy. The policy file is
+
+   gbdt <ntrees> <nnodes> <nleaves> <base>
+   <root>                                         one line per tree
+   <feature> <threshold> <below> <above> <missing>   one line per internal node
+   <value>                                        one line per leaf
+
+where a child >= 0 is an internal node and a child < 0 is the leaf -child-1. Nodes of a tree are numbered in
+depth-first order, so a path is mostly contiguous in memory.
+
+Usage:
+   xgb2policy.py <dump> <out> [--base <margin>]
+"""
+from __future__ import print_function
+import argparse
+import json
+
+
+def flatten(tree, nodes, leaves):
+   """appends the nodes and leaves of tree in depth-first order; returns the child index of its root"""
+   if 'leaf' in tree:
+      leaves.append(float(tree['leaf']))
+      return -len(leaves)
+   idx = len(nodes)
+   nodes.append(None)
+   children = dict((child['nodeid'], child) for child in tree['children'])
+   below = flatten(children[tree['yes']], nodes, leaves)
+   above = flatten(children[tree['no']], nodes, leaves)
+   missing = below if tree.get('missing', tree['yes']) == tree['yes'] else above
+   nodes[idx] = (int(tree['split'].lstrip('f')), float(tree['split_condition']), below, above, missing)
+   return idx
+
+
+if __name__ == '__main__':
+   parser = argparse.ArgumentParser(description='convert an xgboost JSON dump to a gbdt policy')
+   parser.add_argument('dump', help='JSON dump of the booster')
+   parser.add_argument('out', help='policy file to write')
+   parser.add_argument('--base', type=float, default=0.0, help='margin added to the sum of the trees')
+   args = parser.parse_args()
+
+   with open(args.dump, 'r') as fin:
+      trees = json.load(fin)
+
+   nodes, leaves = [], []
+   roots = [flatten(tree, nodes, leaves) for tree in trees]
+
+   with open(args.out, 'w') as fout:
+      fout.write('gbdt %d %d %d %.10g\n' % (len(roots), len(nodes), len(leaves), args.base))
+      for root in roots:
+         fout.write('%d\n' % root)
+      for feature, threshold, below, above, missing in nodes:
+         fout.write('%d %.9g %d %d %d\n' % (feature, threshold, below, above, missing))
+      for value in leaves:
+         fout.write('%.10g\n' % value)
+   print('wrote %d trees with %d nodes and %d leaves to %s' % (len(roots), len(nodes), len(leaves), args.out))
@@ -0,0 +1,421 @@
+/**@file   benchdagger.c
+ * @brief  benchmarks of the hot paths of the node selectors and pruners
+ * @author He He
+ *
+ * The comparator benchmark fills a binary heap, as SCIP's leaf queue does, with random nodes and empties it again,
+ * once comparing the packed sort keys of the policy selectors (see SCIPcalcNodeSortKey()) and once comparing score,
+ * depth and lower bound by epsilon comparisons through the SCIP handle, as the selectors did before; it reports the
+ * time per comparison.
+ *
+ * With --policy, the scoring benchmark reads a policy file as the node selectors and pruners do and scores random
+ * nodes with it, one node per call as the selectors and pruners score a node, and in batches; it reports the time per
+ * node and, with --budget, fails if scoring one node takes longer than the budget, so that `make bench` can check
+ * the latency of a policy before it is deployed.
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scip/scip.h"
+#include "feat.h"
+#include "policy.h"
+
+#define DEFAULT_NNODES     1000000           /**< number of nodes of the heap */
+#define DEFAULT_NROUNDS         10           /**< number of times the heap is filled and emptied */
+#define NSCORES               1000           /**< number of distinct scores, so that ties occur */
+#define NEXAMPLES             1024           /**< number of distinct nodes scored by the scoring benchmark */
+
+/** node of the benchmark heap */
+typedef struct BenchNode
+{
+   SCIP_Real          key;                /**< packed sort key */
+   SCIP_Real          score;              /**< policy score */
+   SCIP_Real          lowerbound;         /**< lower bound */
+   int                depth;              /**< depth */
+} BENCHNODE;
+
+/** comparator of the benchmark heap; returns -1 if node1 is better than node2, +1 if it is worse and 0 otherwise */
+typedef int (*BENCHCOMP)(SCIP* scip, const BENCHNODE* node1, const BENCHNODE* node2);
+
+/** binary heap of nodes with its comparator */
+typedef struct BenchHeap
+{
+   SCIP*              scip;
+   const BENCHNODE**  nodes;
+   int                nnodes;
+   BENCHCOMP          comp;
+   SCIP_Longint       ncomps;             /**< number of comparisons */
+} BENCHHEAP;
+
+/** compare nodes by their sort keys */
+static
+int compKey(
+   SCIP*              scip,
+   const BENCHNODE*   node1,
+   const BENCHNODE*   node2
+   )
+{
+   if( node1->key > node2->key )
+      return -1;
+   else if( node1->key < node2->key )
+      return +1;
+   else
+      return 0;
+}
+
+/** compare nodes by score, depth and lower bound with epsilon comparisons */
+static
+int compEpsilon(
+   SCIP*              scip,
+   const BENCHNODE*   node1,
+   const BENCHNODE*   node2
+   )
+{
+   if( SCIPisGT(scip, node1->score, node2->score) )
+      return -1;
+   else if( SCIPisLT(scip, node1->score, node2->score) )
+      return +1;
+   else if( node1->depth > node2->depth )
+      return -1;
+   else if( node1->depth < node2->depth )
+      return +1;
+   else if( SCIPisLT(scip, node1->lowerbound, node2->lowerbound) )
+      return -1;
+   else if( SCIPisGT(scip, node1->lowerbound, node2->lowerbound) )
+      return +1;
+   else
+      return 0;
+}
+
+/** insert a node into the heap */
+static
+void heapInsert(
+   BENCHHEAP*         heap,
+   const BENCHNODE*   node
+   )
+{
+   int pos;
+
+   pos = heap->nnodes++;
+   while( pos > 0 )
+   {
+      int parent = (pos - 1) / 2;
+
+      heap->ncomps++;
+      if( heap->comp(heap->scip, node, heap->nodes[parent]) >= 0 )
+         break;
+      heap->nodes[pos] = heap->nodes[parent];
+      pos = parent;
+   }
+   heap->nodes[pos] = node;
+}
+
+/** remove the best node from the heap */
+static
+const BENCHNODE* heapRemoveBest(
+   BENCHHEAP*         heap
+   )
+{
+   const BENCHNODE* best;
+   const BENCHNODE* last;
+   int pos;
+
+   assert(heap->nnodes > 0);
+
+   best = heap->nodes[0];
+   last = heap->nodes[--heap->nnodes];
+   pos = 0;
+   while( 2 * pos + 1 < heap->nnodes )
+   {
+      int child = 2 * pos + 1;
+
+      if( child + 1 < heap->nnodes )
+      {
+         heap->ncomps++;
+         if( heap->comp(heap->scip, heap->nodes[child + 1], heap->nodes[child]) < 0 )
+            child++;
+      }
+      heap->ncomps++;
+      if( heap->comp(heap->scip, heap->nodes[child], last) >= 0 )
+         break;
+      heap->nodes[pos] = heap->nodes[child];
+      pos = child;
+   }
+   heap->nodes[pos] = last;
+
+   return best;
+}
+
+/** fill the heap with all nodes and empty it nrounds times; returns the time per comparison in nanoseconds */
+static
+SCIP_RETCODE benchHeap(
+   SCIP*              scip,
+   const BENCHNODE*   nodes,
+   int                nnodes,
+   int                nrounds,
+   BENCHCOMP          comp,
+   SCIP_Real*         nspercomp
+   )
+{
+   BENCHHEAP heap;
+   SCIP_CLOCK* clck;
+   int r;
+   int i;
+
+   heap.scip = scip;
+   heap.nnodes = 0;
+   heap.comp = comp;
+   heap.ncomps = 0;
+   SCIP_CALL( SCIPallocMemoryArray(scip, &heap.nodes, nnodes) );
+   SCIP_CALL( SCIPcreateWallClock(scip, &clck) );
+
+   SCIP_CALL( SCIPstartClock(scip, clck) );
+   for( r = 0; r < nrounds; r++ )
+   {
+      for( i = 0; i < nnodes; i++ )
+         heapInsert(&heap, &nodes[i]);
+      while( heap.nnodes > 0 )
+         (void) heapRemoveBest(&heap);
+   }
+   SCIP_CALL( SCIPstopClock(scip, clck) );
+
+   *nspercomp = 1e9 * SCIPgetClockTime(scip, clck) / MAX(heap.ncomps, 1);
+
+   SCIP_CALL( SCIPfreeClock(scip, &clck) );
+   SCIPfreeMemoryArray(scip, &heap.nodes);
+
+   return SCIP_OKAY;
+}
+
+/** benchmark the comparators of the policy node selectors on a heap of nnodes random nodes */
+static
+SCIP_RETCODE benchComparators(
+   SCIP*              scip,
+   int                nnodes,
+   int                nrounds
+   )
+{
+   BENCHNODE* nodes;
+   SCIP_Real nskey;
+   SCIP_Real nsepsilon;
+   unsigned int seed;
+   int i;
+
+   SCIP_CALL( SCIPallocMemoryArray(scip, &nodes, nnodes) );
+
+   seed = 0;
+   for( i = 0; i < nnodes; i++ )
+   {
+      nodes[i].score = SCIPgetRandomInt(0, NSCORES - 1, &seed) / (SCIP_Real)NSCORES - 0.5;
+      nodes[i].depth = SCIPgetRandomInt(0, 100, &seed);
+      nodes[i].lowerbound = SCIPgetRandomReal(0.0, 1.0, &seed);
+      nodes[i].key = SCIPpackSortKey(nodes[i].score, nodes[i].depth, (int)(255 * nodes[i].lowerbound));
+   }
+
+   SCIP_CALL( benchHeap(scip, nodes, nnodes, nrounds, compKey, &nskey) );
+   SCIP_CALL( benchHeap(scip, nodes, nnodes, nrounds, compEpsilon, &nsepsilon) );
+
+   printf("comparator benchmark: %d nodes, %d rounds\n", nnodes, nrounds);
+   printf("  sort key          : %8.2f ns per comparison\n", nskey);
+   printf("  epsilon compare   : %8.2f ns per comparison\n", nsepsilon);
+
+   SCIPfreeMemoryArray(scip, &nodes);
+
+   return SCIP_OKAY;
+}
+
+/** score nnodes random nodes nrounds times with a policy, one by one and in batches of NEXAMPLES nodes; sets
+ *  *status to 1 if scoring one node takes longer than budget nanoseconds (if budget > 0)
+ */
+static
+SCIP_RETCODE benchPolicy(
+   SCIP*              scip,
+   char*              polfname,
+   int                featsize,
+   int                nnodes,
+   int                nrounds,
+   SCIP_Real          budget,
+   int*               status
+   )
+{
+   SCIP_POLICY* policy;
+   SCIP_CLOCK* single;
+   SCIP_CLOCK* batch;
+   SCIP_Real* examples;
+   SCIP_Real* featvals;
+   SCIP_Real* scores;
+   int* offsets;
+   SCIP_Real checksum;
+   SCIP_Real nssingle;
+   SCIP_Real nsbatch;
+   SCIP_Longint nscored;
+   unsigned int seed;
+   int r;
+   int i;
+   int k;
+
+   SCIP_CALL( SCIPpolicyCreate(scip, &policy) );
+   SCIP_CALL( SCIPreadPolicy(scip, polfname, &policy) );
+   SCIP_CALL( SCIPpolicyCheckFeatSize(scip, policy, featsize, polfname) );
+
+   SCIP_CALL( SCIPallocMemoryArray(scip, &examples, NEXAMPLES * featsize) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &featvals, NEXAMPLES * featsize) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &scores, NEXAMPLES) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &offsets, NEXAMPLES) );
+   SCIP_CALL( SCIPcreateWallClock(scip, &single) );
+   SCIP_CALL( SCIPcreateWallClock(scip, &batch) );
+
+   seed = 0;
+   for( i = 0; i < NEXAMPLES * featsize; i++ )
+      examples[i] = SCIPgetRandomReal(-1.0, 1.0, &seed);
+   for( k = 0; k < NEXAMPLES; k++ )
+      offsets[k] = 0;
+
+   /* policies that normalize the features do so in place, so every pass starts from a copy of the nodes */
+   checksum = 0.0;
+   nscored = 0;
+   for( r = 0; r < nrounds; r++ )
+   {
+      for( i = 0; i < nnodes; i += NEXAMPLES )
+      {
+         int n = MIN(NEXAMPLES, nnodes - i);
+
+         BMScopyMemoryArray(featvals, examples, n * featsize);
+         SCIP_CALL( SCIPstartClock(scip, single) );
+         for( k = 0; k < n; k++ )
+         {
+            SCIPpolicyScoreBatch(policy, &featvals[k * featsize], &offsets[k], featsize, 1, &scores[k]);
+            checksum += scores[k];
+         }
+         SCIP_CALL( SCIPstopClock(scip, single) );
+
+         BMScopyMemoryArray(featvals, examples, n * featsize);
+         SCIP_CALL( SCIPstartClock(scip, batch) );
+         SCIPpolicyScoreBatch(policy, featvals, offsets, featsize, n, scores);
+         SCIP_CALL( SCIPstopClock(scip, batch) );
+         for( k = 0; k < n; k++ )
+            checksum -= scores[k];
+
+         nscored += n;
+      }
+   }
+
+   nssingle = 1e9 * SCIPgetClockTime(scip, single) / MAX(nscored, 1);
+   nsbatch = 1e9 * SCIPgetClockTime(scip, batch) / MAX(nscored, 1);
+
+   printf("scoring benchmark: policy <%s>, %d features, %d nodes, %d rounds\n", polfname, featsize, nnodes, nrounds);
+   printf("  one node per call : %8.2f ns per node\n", nssingle);
+   printf("  batches of %-6d : %8.2f ns per node\n", NEXAMPLES, nsbatch);
+   if( REALABS(checksum) > 1e-6 * MAX(nscored, 1) )
+   {
+      printf("  scores of single and batched calls differ (summed difference %g)\n", checksum);
+      *status = 1;
+   }
+   if( budget > 0.0 && nssingle > budget )
+   {
+      printf("  scoring a node takes %.2f ns, more than the budget of %.2f ns\n", nssingle, budget);
+      *status = 1;
+   }
+
+   SCIP_CALL( SCIPfreeClock(scip, &batch) );
+   SCIP_CALL( SCIPfreeClock(scip, &single) );
+   SCIPfreeMemoryArray(scip, &offsets);
+   SCIPfreeMemoryArray(scip, &scores);
+   SCIPfreeMemoryArray(scip, &featvals);
+   SCIPfreeMemoryArray(scip, &examples);
+   SCIP_CALL( SCIPpolicyFree(scip, &policy) );
+
+   return SCIP_OKAY;
+}
+
+/** run the benchmarks selected by the command line arguments */
+static
+SCIP_RETCODE runBench(
+   int                argc,
+   char**             argv,
+   int*               status
+   )
+{
+   SCIP* scip = NULL;
+   char* polfname;
+   SCIP_Real budget;
+   int featsize;
+   int nnodes;
+   int nrounds;
+   int i;
+
+   polfname = NULL;
+   budget = 0.0;
+   featsize = SCIP_FEATNODEPRU_SIZE;
+   nnodes = DEFAULT_NNODES;
+   nrounds = DEFAULT_NROUNDS;
+   *status = 0;
+
+   for( i = 1; i < argc; i++ )
+   {
+      if( strcmp(argv[i], "--nodes") == 0 && i + 1 < argc )
+         nnodes = atoi(argv[++i]);
+      else if( strcmp(argv[i], "--rounds") == 0 && i + 1 < argc )
+         nrounds = atoi(argv[++i]);
+      else if( strcmp(argv[i], "--policy") == 0 && i + 1 < argc )
+         polfname = argv[++i];
+      else if( strcmp(argv[i], "--featsize") == 0 && i + 1 < argc )
+         featsize = atoi(argv[++i]);
+      else if( strcmp(argv[i], "--budget") == 0 && i + 1 < argc )
+         budget = atof(argv[++i]);
+      else
+      {
+         printf("\nsyntax: %s [--nodes <n>] [--rounds <r>] [--policy <file> [--featsize <n>] [--budget <ns>]]\n"
+            "  --nodes <n>      : number of nodes of the comparator heap and of scored nodes (default %d)\n"
+            "  --rounds <r>     : number of times the heap is filled and emptied or the nodes are scored (default %d)\n"
+            "  --policy <file>  : policy file whose scoring of nodes is timed\n"
+            "  --featsize <n>   : number of features of a node (default %d)\n"
+            "  --budget <ns>    : fail if scoring one node takes longer (default: no budget)\n",
+            argv[0], DEFAULT_NNODES, DEFAULT_NROUNDS, SCIP_FEATNODEPRU_SIZE);
+         *status = 1;
+         return SCIP_OKAY;
+      }
+   }
+   if( nnodes <= 0 || nrounds <= 0 || featsize <= 0 )
+   {
+      printf("number of nodes, rounds and features must be positive\n");
+      *status = 1;
+      return SCIP_OKAY;
+   }
+
+   SCIP_CALL( SCIPcreate(&scip) );
+
+   SCIP_CALL( benchComparators(scip, nnodes, nrounds) );
+   if( polfname != NULL )
+   {
+      SCIP_CALL( benchPolicy(scip, polfname, featsize, nnodes, nrounds, budget, status) );
+   }
+
+   SCIP_CALL( SCIPfree(&scip) );
+
+   BMScheckEmptyMemory();
+
+   return SCIP_OKAY;
+}
+
+int
+main(
+   int                        argc,
+   char**                     argv
+   )
+{
+   SCIP_RETCODE retcode;
+   int status;
+
+   retcode = runBench(argc, argv, &status);
+   if( retcode != SCIP_OKAY )
+   {
+      SCIPprintError(retcode);
+      return -1;
+   }
+
+   return status;
+}
@@ -15,6 +15,7 @@
 #include "nodepru_oracle.h"
 #include "nodepru_dagger.h"
 #include "nodepru_policy.h"
+#include "polindex.h"
 
 /* disable heuristics */
 static
@@ -54,11 +55,75 @@ void disableSepas(
    }
 }
 
+/** set the policy file parameter of an included node selector or pruner to polfname unless a policy was given; an
+ *  included plugin needs a policy, so it is an error if neither was given nor the index entry has one ("-")
+ */
+static
+SCIP_RETCODE setIndexPolicy(
+   SCIP*                 scip,               /**< SCIP data structure */
+   const char*           poldir,             /**< policy directory */
+   const char*           paramname,          /**< name of the policy file parameter */
+   const char*           polfname            /**< policy file selected from the index, or the empty string */
+   )
+{
+   char* value;
+
+   if( SCIPgetParam(scip, paramname) == NULL )
+      return SCIP_OKAY;
+
+   SCIP_CALL( SCIPgetStringParam(scip, paramname, &value) );
+   if( value[0] != '\0' )
+      return SCIP_OKAY;
+
+   if( polfname[0] == '\0' )
+   {
+      SCIPerrorMessage("no policy for <%s>: the entry of <%s/index> nearest to the problem has none (\"-\"); "
+         "give the policy on the command line or add it to the entry\n", paramname, poldir);
+      return SCIP_PARAMETERWRONGVAL;
+   }
+   SCIP_CALL( SCIPsetStringParam(scip, paramname, polfname) );
+
+   return SCIP_OKAY;
+}
+
+/** select the policies nearest to the fingerprint of the problem from the index of the policy directory */
+static
+SCIP_RETCODE selectIndexPolicies(
+   SCIP*                 scip,               /**< SCIP data structure */
+   const char*           poldir,             /**< policy directory, or NULL */
+   SCIP_Bool             printonly           /**< only print the fingerprint? */
+   )
+{
+   SCIP_Real fingerprint[SCIP_FINGERPRINT_SIZE];
+   char nodeselpol[SCIP_MAXSTRLEN];
+   char nodeprupol[SCIP_MAXSTRLEN];
+   int i;
+
+   SCIP_CALL( SCIPcalcFingerprint(scip, fingerprint) );
+   SCIPinfoMessage(scip, NULL, "instance fingerprint:");
+   for( i = 0; i < SCIP_FINGERPRINT_SIZE; i++ )
+      SCIPinfoMessage(scip, NULL, " %g", fingerprint[i]);
+   SCIPinfoMessage(scip, NULL, "\n");
+
+   if( printonly || poldir == NULL )
+      return SCIP_OKAY;
+
+   SCIP_CALL( SCIPpolindexSelect(scip, poldir, fingerprint, nodeselpol, nodeprupol) );
+   SCIP_CALL( setIndexPolicy(scip, poldir, "nodeselection/policy/polfname", nodeselpol) );
+   SCIP_CALL( setIndexPolicy(scip, poldir, "nodeselection/dagger/polfname", nodeselpol) );
+   SCIP_CALL( setIndexPolicy(scip, poldir, "nodepruning/policy/polfname", nodeprupol) );
+   SCIP_CALL( setIndexPolicy(scip, poldir, "nodepruning/dagger/polfname", nodeprupol) );
+
+   return SCIP_OKAY;
+}
+
 static
 SCIP_RETCODE fromCommandLine(
    SCIP*                 scip,               /**< SCIP data structure */
    const char*           filename,           /**< input file name */
-   const char*           solfname            /**< input file name */
+   const char*           solfname,           /**< input file name */
+   const char*           poldir,             /**< directory to select the policies from, or NULL */
+   SCIP_Bool             fingerprint         /**< only print the fingerprint of the problem? */
    )
 {
    SCIP_RETCODE retcode;
@@ -97,6 +162,13 @@ SCIP_RETCODE fromCommandLine(
       SCIP_CALL( retcode );
    } /*lint !e788*/
 
+   if( poldir != NULL || fingerprint )
+   {
+      SCIP_CALL( selectIndexPolicies(scip, poldir, fingerprint) );
+      if( fingerprint )
+         return SCIP_OKAY;
+   }
+
    /*******************
     * Problem Solving *
     *******************/
@@ -167,11 +239,14 @@ SCIP_RETCODE processShellArguments(
    char* nodepruname = NULL;
    char* nodeprutrj = NULL;
    char* nodeprupol= NULL;
+   char* poldir = NULL;                      /**< directory to select missing policies from by the problem fingerprint */
+   SCIP_Bool fingerprint = FALSE;            /**< only print the fingerprint of the problem? */
    SCIP_Bool solrequired = FALSE;
    SCIP_Bool quiet;
    int freq = 1;                             /**< frequency of heuristics and separators */ 
    SCIP_Longint nodelimit = -1;              /**< maximum number of nodes to process */
    SCIP_Real timelimit = -1;                 /**< maximum number of nodes to process */
+   SCIP_Real memlimit = -1;                  /**< maximum memory in MB */
    SCIP_Bool paramerror;
    int i;
 
@@ -240,6 +315,17 @@ SCIP_RETCODE processShellArguments(
             paramerror = TRUE;
          }
       }
+      else if( strcmp(argv[i], "-m") == 0 )
+      {
+         i++;
+         if( i < argc )
+            memlimit = atof(argv[i]);
+         else
+         {
+            printf("missing memory limit after parameter '-m'\n");
+            paramerror = TRUE;
+         }
+      }
       else if( strcmp(argv[i], "-s") == 0 )
       {
          i++;
@@ -294,16 +380,12 @@ SCIP_RETCODE processShellArguments(
             if( strcmp(nodepruname, "oracle") == 0 || strcmp(nodepruname, "dagger") == 0 )
                solrequired = TRUE;
 
-            if( strcmp(nodepruname, "policy") == 0 || strcmp(nodepruname, "dagger") == 0 )
+            /* the policy may be omitted if it is selected from a policy directory */
+            if( (strcmp(nodepruname, "policy") == 0 || strcmp(nodepruname, "dagger") == 0)
+               && i + 1 < argc && argv[i+1][0] != '-' )
             {
                i++;
-               if( i < argc && argv[i][0] != '-' )
-                  nodeprupol = argv[i];
-               else
-               {
-                  printf("missing policy of node pruner '%s'\n", nodepruname);
-                  paramerror = TRUE;
-               }
+               nodeprupol = argv[i];
             }
          }
          else
@@ -333,16 +415,12 @@ SCIP_RETCODE processShellArguments(
             if( strcmp(nodeselname, "oracle") == 0 || strcmp(nodeselname, "dagger") == 0 )
                solrequired = TRUE;
 
-            if( strcmp(nodeselname, "policy") == 0 || strcmp(nodeselname, "dagger") == 0 )
+            /* the policy may be omitted if it is selected from a policy directory */
+            if( (strcmp(nodeselname, "policy") == 0 || strcmp(nodeselname, "dagger") == 0)
+               && i + 1 < argc && argv[i+1][0] != '-' )
             {
                i++;
-               if( i < argc && argv[i][0] != '-' )
-                  nodeselpol = argv[i];
-               else
-               {
-                  printf("missing policy of node selector '%s'\n", nodeselname);
-                  paramerror = TRUE;
-               }
+               nodeselpol = argv[i];
             }
          }
          else
@@ -362,6 +440,19 @@ SCIP_RETCODE processShellArguments(
             paramerror = TRUE;
          }
       }
+      else if( strcmp(argv[i], "--poldir") == 0 )
+      {
+         i++;
+         if( i < argc )
+            poldir = argv[i];
+         else
+         {
+            printf("missing policy directory after parameter '--poldir'\n");
+            paramerror = TRUE;
+         }
+      }
+      else if( strcmp(argv[i], "--fingerprint") == 0 )
+         fingerprint = TRUE;
       else
       {
          printf("invalid parameter <%s>\n", argv[i]);
@@ -375,6 +466,20 @@ SCIP_RETCODE processShellArguments(
       paramerror = TRUE;
    }
 
+   if( nodepruname != NULL && nodeprupol == NULL && poldir == NULL
+      && (strcmp(nodepruname, "policy") == 0 || strcmp(nodepruname, "dagger") == 0) )
+   {
+      printf("missing policy of node pruner '%s'\n", nodepruname);
+      paramerror = TRUE;
+   }
+
+   if( nodeselname != NULL && nodeselpol == NULL && poldir == NULL
+      && (strcmp(nodeselname, "policy") == 0 || strcmp(nodeselname, "dagger") == 0) )
+   {
+      printf("missing policy of node selector '%s'\n", nodeselname);
+      paramerror = TRUE;
+   }
+
    if( !paramerror )
    {
       /***********************************
@@ -414,6 +519,12 @@ SCIP_RETCODE processShellArguments(
          printf("Maximum number of nodes to explore: %"SCIP_LONGINT_FORMAT"\n", nodelimit);
       }
 
+      if( memlimit > -1 )
+      {
+         SCIP_CALL( SCIPsetRealParam(scip, "limits/memory", memlimit) );
+         printf("Maximal memory to use: %.2f MB\n", memlimit);
+      }
+
       if( logname != NULL )
       {
          SCIPsetMessagehdlrLogfile(scip, logname);
@@ -438,14 +549,20 @@ SCIP_RETCODE processShellArguments(
          {
             SCIP_CALL( SCIPincludeNodepruDagger(scip) );
             SCIP_CALL( SCIPsetStringParam(scip, "nodepruning/dagger/solfname", solfname) );
-            SCIP_CALL( SCIPsetStringParam(scip, "nodepruning/dagger/polfname", nodeprupol) );
+            if( nodeprupol != NULL )
+            {
+               SCIP_CALL( SCIPsetStringParam(scip, "nodepruning/dagger/polfname", nodeprupol) );
+            }
             if( nodeprutrj != NULL )
                SCIP_CALL( SCIPsetStringParam(scip, "nodepruning/dagger/trjfname", nodeprutrj) );
          }
          else if( strcmp(nodepruname, "policy") == 0 )
          {
             SCIP_CALL( SCIPincludeNodepruPolicy(scip) );
-            SCIP_CALL( SCIPsetStringParam(scip, "nodepruning/policy/polfname", nodeprupol) );
+            if( nodeprupol != NULL )
+            {
+               SCIP_CALL( SCIPsetStringParam(scip, "nodepruning/policy/polfname", nodeprupol) );
+            }
          }
          else
          {
@@ -468,14 +585,20 @@ SCIP_RETCODE processShellArguments(
          {
             SCIP_CALL( SCIPincludeNodeselDagger(scip) );
             SCIP_CALL( SCIPsetStringParam(scip, "nodeselection/dagger/solfname", solfname) );
-            SCIP_CALL( SCIPsetStringParam(scip, "nodeselection/dagger/polfname", nodeselpol) );
+            if( nodeselpol != NULL )
+            {
+               SCIP_CALL( SCIPsetStringParam(scip, "nodeselection/dagger/polfname", nodeselpol) );
+            }
             if( nodeseltrj != NULL )
                SCIP_CALL( SCIPsetStringParam(scip, "nodeselection/dagger/trjfname", nodeseltrj) );
          }
          else if( strcmp(nodeselname, "policy") == 0 )
          {
             SCIP_CALL( SCIPincludeNodeselPolicy(scip) );
-            SCIP_CALL( SCIPsetStringParam(scip, "nodeselection/policy/polfname", nodeselpol) );
+            if( nodeselpol != NULL )
+            {
+               SCIP_CALL( SCIPsetStringParam(scip, "nodeselection/policy/polfname", nodeselpol) );
+            }
          }
          else
          {
@@ -522,7 +645,7 @@ SCIP_RETCODE processShellArguments(
 
       if( probname != NULL )
       {
-         SCIP_CALL( fromCommandLine(scip, probname, outputsolfname) );
+         SCIP_CALL( fromCommandLine(scip, probname, outputsolfname, poldir, fingerprint) );
       }
       else
       {
@@ -532,12 +655,15 @@ SCIP_RETCODE processShellArguments(
    }
    else
    {
-      printf("\nsyntax: %s [-l <logfile>] [-q] [-s <settings>] [-f <problem>] [-o <solution>]\n"
-         "  -l <logfile>  : copy output into log file\n"
-         "  -q            : suppress screen messages\n"
-         "  -s <settings> : load parameter settings (.set) file\n"
-         "  -f <problem>  : load and solve problem file\n"
-         "  -o <solution> : load optimal solution file\n",
+      printf("\nsyntax: %s [-l <logfile>] [-q] [-s <settings>] [-f <problem>] [-o <solution>] [--poldir <dir>]"
+         " [--fingerprint]\n"
+         "  -l <logfile>     : copy output into log file\n"
+         "  -q               : suppress screen messages\n"
+         "  -s <settings>    : load parameter settings (.set) file\n"
+         "  -f <problem>     : load and solve problem file\n"
+         "  -o <solution>    : load optimal solution file\n"
+         "  --poldir <dir>   : select the policies not given by the problem fingerprint from <dir>/index\n"
+         "  --fingerprint    : print the fingerprint of the problem without solving it\n",
          argv[0]);
    }
 
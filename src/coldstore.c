@@ -0,0 +1,508 @@
+/**@file   coldstore.c
+ * @brief  methods for the cold store of pruned nodes
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <string.h>
+#include "scip/def.h"
+#include "coldstore.h"
+#include "scip/struct_scip.h"
+
+#define EVENTHDLR_DESC         "revisits the nodes parked in a cold store when the tree is empty"
+#define HASHMAPFACTOR          5             /**< size of the variable map relative to the number of variables */
+
+/** upper bound on the bytes of a record with n branchings: length, lower bound, score, number of branchings, and
+ *  per branching the key delta and the bound
+ */
+#define MAXRECORDSIZE(n)       (10 + sizeof(SCIP_Real) + sizeof(float) + 5 + (n) * (10 + 10))
+
+/** write val as a varint, 7 bits per byte with the high bit marking continuation; returns the number of bytes */
+static
+int coldstoreWriteVarint(
+   unsigned char*     pos,
+   SCIP_Longint       val
+   )
+{
+   unsigned long long uval = (unsigned long long)val;
+   int n = 0;
+
+   while( uval >= 0x80 )
+   {
+      pos[n++] = (unsigned char)(uval | 0x80);
+      uval >>= 7;
+   }
+   pos[n++] = (unsigned char)uval;
+
+   return n;
+}
+
+/** read a varint and advance pos */
+static
+SCIP_Longint coldstoreReadVarint(
+   unsigned char**    pos
+   )
+{
+   unsigned long long uval = 0;
+   int shift = 0;
+
+   while( **pos & 0x80 )
+   {
+      uval |= (unsigned long long)(**pos & 0x7f) << shift;
+      shift += 7;
+      (*pos)++;
+   }
+   uval |= (unsigned long long)**pos << shift;
+   (*pos)++;
+
+   return (SCIP_Longint)uval;
+}
+
+/** map signed to unsigned integers such that small absolute values get short varints */
+#define zigzagEncode(v)        ((SCIP_Longint)(((unsigned long long)(v) << 1) ^ (unsigned long long)((v) >> 63)))
+#define zigzagDecode(u)        ((SCIP_Longint)(((unsigned long long)(u) >> 1) ^ (0ULL - ((unsigned long long)(u) & 1))))
+
+SCIP_RETCODE SCIPcoldstoreCreate(
+   SCIP*              scip,
+   SCIP_COLDSTORE**   store,
+   SCIP_Longint       nodelimit
+   )
+{
+   assert(scip != NULL);
+   assert(store != NULL);
+
+   SCIP_CALL( SCIPallocBlockMemory(scip, store) );
+   (*store)->buf = NULL;
+   (*store)->buflen = 0;
+   (*store)->bufsize = 0;
+   (*store)->nrecords = 0;
+   (*store)->nodelimit = nodelimit;
+   (*store)->nparked = 0;
+   (*store)->nrevisited = 0;
+   (*store)->nsols = 0;
+   (*store)->nbytes = 0;
+
+   return SCIP_OKAY;
+}
+
+SCIP_RETCODE SCIPcoldstoreFree(
+   SCIP*              scip,
+   SCIP_COLDSTORE**   store
+   )
+{
+   assert(scip != NULL);
+   assert(store != NULL);
+   assert(*store != NULL);
+
+   SCIPfreeMemoryArrayNull(scip, &(*store)->buf);
+   SCIPfreeBlockMemory(scip, store);
+
+   return SCIP_OKAY;
+}
+
+SCIP_RETCODE SCIPcoldstoreAdd(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store,
+   SCIP_NODE*         node,
+   SCIP_Real          score
+   )
+{
+   SCIP_VAR** branchvars;
+   SCIP_Real* branchbounds;
+   SCIP_BOUNDTYPE* boundtypes;
+   SCIP_Longint* keys;
+   SCIP_Longint prevkey;
+   SCIP_Real lowerbound;
+   unsigned char* body;
+   unsigned char* pos;
+   float fscore;
+   int nbranchvars;
+   int nkeys;
+   int size;
+   int i;
+
+   assert(scip != NULL);
+   assert(store != NULL);
+   assert(node != NULL);
+
+   /* get the branchings on the path of the node */
+   size = SCIPnodeGetDepth(node) + 1;
+   SCIP_CALL( SCIPallocBufferArray(scip, &branchvars, size) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &branchbounds, size) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &boundtypes, size) );
+   SCIPnodeGetAncestorBranchings(node, branchvars, branchbounds, boundtypes, &nbranchvars, size);
+   if( nbranchvars > size )
+   {
+      size = nbranchvars;
+      SCIP_CALL( SCIPreallocBufferArray(scip, &branchvars, size) );
+      SCIP_CALL( SCIPreallocBufferArray(scip, &branchbounds, size) );
+      SCIP_CALL( SCIPreallocBufferArray(scip, &boundtypes, size) );
+      SCIPnodeGetAncestorBranchings(node, branchvars, branchbounds, boundtypes, &nbranchvars, size);
+   }
+
+   /* sort the branchings by variable and bound type, ties by position on the path; since the path starts at the node,
+    * the first branching of a variable and bound type is the tightest one and the others can be dropped
+    */
+   SCIP_CALL( SCIPallocBufferArray(scip, &keys, nbranchvars) );
+   for( i = 0; i < nbranchvars; i++ )
+      keys[i] = (2 * (SCIP_Longint)SCIPvarGetProbindex(branchvars[i]) + (boundtypes[i] == SCIP_BOUNDTYPE_UPPER ? 1 : 0))
+         * nbranchvars + i;
+   SCIPsortLong(keys, nbranchvars);
+   nkeys = 0;
+   for( i = 0; i < nbranchvars; i++ )
+   {
+      if( nkeys > 0 && keys[i] / nbranchvars == keys[nkeys - 1] / nbranchvars )
+         continue;
+      keys[nkeys++] = keys[i];
+   }
+
+   /* encode the record body: lower bound, score as a float, number of branchings, and per branching the delta of the
+    * key (variable and bound type) to the previous one, shifted by a flag for integral bounds, followed by the bound as
+    * a zigzag varint if it is integral and as a double otherwise
+    */
+   SCIP_CALL( SCIPallocBufferArray(scip, &body, MAXRECORDSIZE(nkeys)) );
+   pos = body;
+   lowerbound = SCIPnodeGetLowerbound(node);
+   memcpy(pos, &lowerbound, sizeof(SCIP_Real));
+   pos += sizeof(SCIP_Real);
+   fscore = (float)score;
+   memcpy(pos, &fscore, sizeof(float));
+   pos += sizeof(float);
+   pos += coldstoreWriteVarint(pos, nkeys);
+   prevkey = 0;
+   for( i = 0; i < nkeys; i++ )
+   {
+      SCIP_Longint key = keys[i] / nbranchvars;
+      SCIP_Real bound = branchbounds[keys[i] % nbranchvars];
+      SCIP_Bool integral = SCIPisIntegral(scip, bound) && REALABS(bound) < 1e15;
+
+      pos += coldstoreWriteVarint(pos, 2 * (key - prevkey) + (integral ? 1 : 0));
+      prevkey = key;
+      if( integral )
+         pos += coldstoreWriteVarint(pos, zigzagEncode((SCIP_Longint)SCIPround(scip, bound)));
+      else
+      {
+         memcpy(pos, &bound, sizeof(SCIP_Real));
+         pos += sizeof(SCIP_Real);
+      }
+   }
+
+   /* append the body prefixed by its length */
+   if( store->buflen + 10 + (pos - body) > store->bufsize )
+   {
+      store->bufsize = MAX(2 * store->bufsize, store->buflen + 10 + (pos - body));
+      SCIP_CALL( SCIPreallocMemoryArray(scip, &store->buf, store->bufsize) );
+   }
+   size = coldstoreWriteVarint(store->buf + store->buflen, pos - body);
+   memcpy(store->buf + store->buflen + size, body, pos - body);
+   store->nbytes += size + (pos - body);
+   store->buflen += size + (pos - body);
+   store->nrecords++;
+   store->nparked++;
+
+   SCIPdebugMessage("parked node #%"SCIP_LONGINT_FORMAT" with %d branchings in %d bytes\n",
+      SCIPnodeGetNumber(node), nkeys, size + (int)(pos - body));
+
+   SCIPfreeBufferArray(scip, &body);
+   SCIPfreeBufferArray(scip, &keys);
+   SCIPfreeBufferArray(scip, &boundtypes);
+   SCIPfreeBufferArray(scip, &branchbounds);
+   SCIPfreeBufferArray(scip, &branchvars);
+
+   return SCIP_OKAY;
+}
+
+/** solve the node of the record at offset in a sub-SCIP restricted to its branchings and add an improving solution
+ *  to scip
+ */
+static
+SCIP_RETCODE coldstoreSolveRecord(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store,
+   SCIP_Longint       offset,
+   SCIP_Real          timelimit,
+   SCIP_Real          memorylimit
+   )
+{
+   SCIP* subscip;
+   SCIP_HASHMAP* varmap;
+   SCIP_VAR** vars;
+   SCIP_VAR** subvars;
+   SCIP_Real* vals;
+   SCIP_RETCODE retcode;
+   SCIP_Longint key;
+   unsigned char* pos;
+   SCIP_Bool valid;
+   SCIP_Bool infeasible;
+   int nkeys;
+   int nvars;
+   int i;
+
+   vars = SCIPgetVars(scip);
+   nvars = SCIPgetNVars(scip);
+
+   SCIP_CALL( SCIPcreate(&subscip) );
+   SCIP_CALL( SCIPhashmapCreate(&varmap, SCIPblkmem(subscip), SCIPcalcHashtableSize(HASHMAPFACTOR * nvars)) );
+   valid = FALSE;
+   SCIP_CALL( SCIPcopy(scip, subscip, varmap, NULL, "cold", TRUE, FALSE, TRUE, &valid) );
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &subvars, nvars) );
+   for( i = 0; i < nvars; i++ )
+      subvars[i] = (SCIP_VAR*) SCIPhashmapGetImage(varmap, vars[i]);
+   SCIPhashmapFree(&varmap);
+
+   /* restrict the copy to the subtree of the parked node by replaying its branchings; the global bounds may have been
+    * tightened since the node was parked, e.g., for leaves evicted long after their creation, so a branching can make
+    * the subtree infeasible
+    */
+   pos = store->buf + offset;
+   (void) coldstoreReadVarint(&pos);
+   pos += sizeof(SCIP_Real) + sizeof(float);
+   nkeys = (int)coldstoreReadVarint(&pos);
+   key = 0;
+   infeasible = FALSE;
+   for( i = 0; i < nkeys && !infeasible; i++ )
+   {
+      SCIP_VAR* subvar;
+      SCIP_Real bound;
+      SCIP_Longint code;
+      int probindex;
+
+      code = coldstoreReadVarint(&pos);
+      key += code / 2;
+      if( code % 2 == 1 )
+      {
+         code = coldstoreReadVarint(&pos);
+         bound = (SCIP_Real)zigzagDecode(code);
+      }
+      else
+      {
+         memcpy(&bound, pos, sizeof(SCIP_Real));
+         pos += sizeof(SCIP_Real);
+      }
+
+      probindex = (int)(key / 2);
+      if( probindex >= nvars || subvars[probindex] == NULL )
+         continue;
+      subvar = subvars[probindex];
+
+      if( key % 2 == 0 )
+      {
+         if( SCIPisFeasGT(scip, bound, SCIPvarGetUbGlobal(subvar)) )
+            infeasible = TRUE;
+         else if( SCIPisGT(scip, bound, SCIPvarGetLbGlobal(subvar)) )
+         {
+            SCIP_CALL( SCIPchgVarLb(subscip, subvar, bound) );
+         }
+      }
+      else
+      {
+         if( SCIPisFeasLT(scip, bound, SCIPvarGetLbGlobal(subvar)) )
+            infeasible = TRUE;
+         else if( SCIPisLT(scip, bound, SCIPvarGetUbGlobal(subvar)) )
+         {
+            SCIP_CALL( SCIPchgVarUb(subscip, subvar, bound) );
+         }
+      }
+   }
+
+   if( infeasible )
+   {
+      SCIPdebugMessage("parked node at offset %"SCIP_LONGINT_FORMAT" is infeasible for the global bounds\n", offset);
+      SCIPfreeBufferArray(scip, &subvars);
+      SCIP_CALL( SCIPfree(&subscip) );
+      return SCIP_OKAY;
+   }
+
+   SCIP_CALL( SCIPsetIntParam(subscip, "display/verblevel", 0) );
+   SCIP_CALL( SCIPsetBoolParam(subscip, "misc/catchctrlc", FALSE) );
+   SCIP_CALL( SCIPsetLongintParam(subscip, "limits/nodes", store->nodelimit) );
+   SCIP_CALL( SCIPsetRealParam(subscip, "limits/time", timelimit) );
+   SCIP_CALL( SCIPsetRealParam(subscip, "limits/memory", memorylimit) );
+   if( !SCIPisInfinity(scip, SCIPgetUpperbound(scip)) )
+   {
+      SCIP_CALL( SCIPsetObjlimit(subscip, SCIPgetUpperbound(scip)) );
+   }
+
+   /* errors in the sub-SCIP should not stop the solve of the main problem */
+   retcode = SCIPsolve(subscip);
+   if( retcode != SCIP_OKAY )
+   {
+      SCIPwarningMessage(scip, "Error while solving a parked node; sub-SCIP terminated with code <%d>\n", retcode);
+   }
+   else if( SCIPgetNSols(subscip) > 0 )
+   {
+      SCIP_SOL* newsol;
+      SCIP_Bool success;
+
+      SCIP_CALL( SCIPallocBufferArray(scip, &vals, nvars) );
+      for( i = 0; i < nvars; i++ )
+         vals[i] = subvars[i] == NULL ? 0.0 : SCIPgetSolVal(subscip, SCIPgetBestSol(subscip), subvars[i]);
+
+      SCIP_CALL( SCIPcreateSol(scip, &newsol, NULL) );
+      SCIP_CALL( SCIPsetSolVals(scip, newsol, nvars, vars, vals) );
+      SCIP_CALL( SCIPtrySolFree(scip, &newsol, FALSE, TRUE, TRUE, TRUE, &success) );
+      if( success )
+         store->nsols++;
+
+      SCIPfreeBufferArray(scip, &vals);
+   }
+   store->nrevisited++;
+
+   SCIPfreeBufferArray(scip, &subvars);
+   SCIP_CALL( SCIPfree(&subscip) );
+
+   return SCIP_OKAY;
+}
+
+SCIP_RETCODE SCIPcoldstoreRevisit(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store
+   )
+{
+   SCIP_Real timelimit;
+   SCIP_Real memorylimit;
+   SCIP_Real* lowerbounds;
+   SCIP_Longint* offsets;
+   unsigned char* pos;
+   int* order;
+   int i;
+
+   assert(scip != NULL);
+   assert(store != NULL);
+
+   if( store->nrecords == 0 )
+      return SCIP_OKAY;
+
+   SCIPdebugMessage("revisiting %d parked nodes\n", store->nrecords);
+
+   /* index the records by their lower bounds */
+   SCIP_CALL( SCIPallocBufferArray(scip, &lowerbounds, store->nrecords) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &offsets, store->nrecords) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &order, store->nrecords) );
+   pos = store->buf;
+   for( i = 0; i < store->nrecords; i++ )
+   {
+      SCIP_Longint len;
+
+      order[i] = i;
+      offsets[i] = pos - store->buf;
+      len = coldstoreReadVarint(&pos);
+      memcpy(&lowerbounds[i], pos, sizeof(SCIP_Real));
+      pos += len;
+   }
+   assert(pos == store->buf + store->buflen);
+   SCIPsortRealInt(lowerbounds, order, store->nrecords);
+
+   SCIP_CALL( SCIPgetRealParam(scip, "limits/time", &timelimit) );
+   SCIP_CALL( SCIPgetRealParam(scip, "limits/memory", &memorylimit) );
+   for( i = 0; i < store->nrecords; i++ )
+   {
+      SCIP_Real remaining;
+      SCIP_Real memremaining;
+
+      /* the remaining nodes are cut off by the incumbent */
+      if( SCIPisGE(scip, lowerbounds[i], SCIPgetCutoffbound(scip)) )
+         break;
+
+      remaining = timelimit - SCIPgetSolvingTime(scip);
+      if( !SCIPisInfinity(scip, timelimit) && remaining <= 0.0 )
+         break;
+
+      /* the sub-SCIP gets the memory not used by scip and external software, as the sub-MIP heuristics of SCIP do */
+      memremaining = memorylimit;
+      if( !SCIPisInfinity(scip, memorylimit) )
+      {
+         memremaining -= SCIPgetMemUsed(scip) / 1048576.0;
+         memremaining -= SCIPgetMemExternEstim(scip) / 1048576.0;
+         if( memremaining <= 2.0 * SCIPgetMemExternEstim(scip) / 1048576.0 )
+            break;
+      }
+
+      SCIP_CALL( coldstoreSolveRecord(scip, store, offsets[order[i]], remaining, memremaining) );
+   }
+
+   SCIPfreeBufferArray(scip, &order);
+   SCIPfreeBufferArray(scip, &offsets);
+   SCIPfreeBufferArray(scip, &lowerbounds);
+
+   /* parked nodes are revisited only once */
+   store->nrecords = 0;
+   store->buflen = 0;
+
+   return SCIP_OKAY;
+}
+
+/** execution method of event handler: revisit the store if the solved node was the last one */
+static
+SCIP_DECL_EVENTEXEC(eventExecColdstore)
+{
+   SCIP_COLDSTORE** store;
+
+   store = (SCIP_COLDSTORE**) SCIPeventhdlrGetData(eventhdlr);
+   assert(store != NULL);
+
+   if( *store != NULL && SCIPgetNNodesLeft(scip) == 0 )
+   {
+      SCIP_CALL( SCIPcoldstoreRevisit(scip, *store) );
+   }
+
+   return SCIP_OKAY;
+}
+
+/** solving process initialization method of event handler */
+static
+SCIP_DECL_EVENTINITSOL(eventInitsolColdstore)
+{
+   SCIP_CALL( SCIPcatchEvent(scip, SCIP_EVENTTYPE_NODESOLVED, eventhdlr, NULL, NULL) );
+
+   return SCIP_OKAY;
+}
+
+/** solving process deinitialization method of event handler */
+static
+SCIP_DECL_EVENTEXITSOL(eventExitsolColdstore)
+{
+   SCIP_CALL( SCIPdropEvent(scip, SCIP_EVENTTYPE_NODESOLVED, eventhdlr, NULL, -1) );
+
+   return SCIP_OKAY;
+}
+
+SCIP_RETCODE SCIPincludeEventhdlrColdstore(
+   SCIP*              scip,
+   const char*        name,
+   SCIP_COLDSTORE**   store
+   )
+{
+   SCIP_EVENTHDLR* eventhdlr;
+
+   eventhdlr = NULL;
+   SCIP_CALL( SCIPincludeEventhdlrBasic(scip, &eventhdlr, name, EVENTHDLR_DESC, eventExecColdstore,
+         (SCIP_EVENTHDLRDATA*) store) );
+   assert(eventhdlr != NULL);
+
+   SCIP_CALL( SCIPsetEventhdlrInitsol(scip, eventhdlr, eventInitsolColdstore) );
+   SCIP_CALL( SCIPsetEventhdlrExitsol(scip, eventhdlr, eventExitsolColdstore) );
+
+   return SCIP_OKAY;
+}
+
+void SCIPcoldstorePrintStatistics(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store,
+   FILE*              file
+   )
+{
+   assert(scip != NULL);
+   assert(store != NULL);
+
+   SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  nodes parked     : %10d\n", store->nparked);
+   SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  bytes per node   : %10.1f\n", store->nparked > 0 ? (SCIP_Real)store->nbytes / store->nparked : 0.0);
+   SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  nodes revisited  : %10d\n", store->nrevisited);
+   SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  revisit sols     : %10d\n", store->nsols);
+}
@@ -0,0 +1,74 @@
+/**@file   coldstore.h
+ * @brief  internal methods for the cold store of pruned nodes
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_COLDSTORE_H__
+#define __SCIP_COLDSTORE_H__
+
+#include "scip/def.h"
+#include "scip/scip.h"
+#include "struct_coldstore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** create an empty cold store; parked nodes are revisited by sub-SCIPs with at most nodelimit nodes */
+extern
+SCIP_RETCODE SCIPcoldstoreCreate(
+   SCIP*              scip,
+   SCIP_COLDSTORE**   store,
+   SCIP_Longint       nodelimit
+   );
+
+/** free the cold store and the nodes parked in it */
+extern
+SCIP_RETCODE SCIPcoldstoreFree(
+   SCIP*              scip,
+   SCIP_COLDSTORE**   store
+   );
+
+/** park node, i.e., serialize its branching path, lower bound and score; the node itself can then be cut off */
+extern
+SCIP_RETCODE SCIPcoldstoreAdd(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store,
+   SCIP_NODE*         node,
+   SCIP_Real          score
+   );
+
+/** solve the parked nodes whose lower bound is below the cutoff bound in sub-SCIPs, in the order of their lower
+ *  bounds and while time and memory remain; improving solutions are added to scip and the store is emptied
+ */
+extern
+SCIP_RETCODE SCIPcoldstoreRevisit(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store
+   );
+
+/** include an event handler that revisits the store *store, if it exists, when the tree becomes empty after a node
+ *  was solved
+ */
+extern
+SCIP_RETCODE SCIPincludeEventhdlrColdstore(
+   SCIP*              scip,
+   const char*        name,
+   SCIP_COLDSTORE**   store
+   );
+
+/** print statistics of the cold store */
+extern
+void SCIPcoldstorePrintStatistics(
+   SCIP*              scip,
+   SCIP_COLDSTORE*    store,
+   FILE*              file
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
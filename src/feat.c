@@ -15,6 +15,13 @@
 #include "scip/struct_scip.h"
 #include "math.h"
 
+#define PATHMAPSIZE          65536           /**< size of the hash map of node path records, and the least number of
+                                              *   records at which those of closed nodes are dropped */
+
+#define DEFAULT_INSTFEATS       FALSE        /**< append the instance features to the node features? */
+#define DEFAULT_BRANCHFEATS     FALSE        /**< append the branching aggregates to the node features? */
+#define DEFAULT_PATHFEATS       FALSE        /**< append the path features to the node features? */
+
 /** copy feature vector value */
 void SCIPfeatCopy(
    SCIP_FEAT*           feat,
@@ -35,6 +42,10 @@ void SCIPfeatCopy(
    sourcefeat->rootlpobj = feat->rootlpobj;
    sourcefeat->sumobjcoeff = feat->sumobjcoeff;
    sourcefeat->nconstrs = feat->nconstrs;
+   sourcefeat->instoffset = feat->instoffset;
+   sourcefeat->instdone = feat->instdone;
+   sourcefeat->branchoffset = feat->branchoffset;
+   sourcefeat->pathoffset = feat->pathoffset;
 
    for( i = 0; i < feat->size; i++ )
       sourcefeat->vals[i] = feat->vals[i];
@@ -65,6 +76,686 @@ SCIP_RETCODE SCIPfeatCreate(
    (*feat)->depth = 0;
    (*feat)->size = size;
    (*feat)->boundtype = 0;
+   (*feat)->instoffset = 0;
+   (*feat)->instdone = FALSE;
+   (*feat)->branchoffset = 0;
+   (*feat)->memo = NULL;
+   (*feat)->nmemo = 0;
+   (*feat)->memoround = 0;
+   (*feat)->memonlps = -1;
+   (*feat)->memonactivatednodes = -1;
+   (*feat)->memonboundchgs = -1;
+   (*feat)->pathoffset = 0;
+   (*feat)->pathstore = NULL;
+   (*feat)->keylowerbound = 0;
+   (*feat)->keyboundrange = 0;
+
+   return SCIP_OKAY;
+}
+
+/** append the instance features to the feature vector; they are computed at the first node and kept for all nodes */
+static
+SCIP_RETCODE featAddInstanceFeat(
+   SCIP_FEAT*           feat
+   )
+{
+   int i;
+
+   assert(feat != NULL);
+   assert(feat->instoffset == 0);
+
+   SCIP_ALLOC( BMSreallocMemoryArray(&feat->vals, feat->size + SCIP_FEATINST_SIZE) );
+   for( i = feat->size; i < feat->size + SCIP_FEATINST_SIZE; i++ )
+      feat->vals[i] = 0;
+
+   feat->instoffset = feat->size;
+   feat->size += SCIP_FEATINST_SIZE;
+
+   return SCIP_OKAY;
+}
+
+/** append the maxima and the number of the branching bound changes of a node to the feature vector */
+static
+SCIP_RETCODE featAddBranchFeat(
+   SCIP_FEAT*           feat
+   )
+{
+   int i;
+
+   assert(feat != NULL);
+   assert(feat->branchoffset == 0);
+
+   SCIP_ALLOC( BMSreallocMemoryArray(&feat->vals, feat->size + SCIP_FEATBRANCH_SIZE) );
+   for( i = feat->size; i < feat->size + SCIP_FEATBRANCH_SIZE; i++ )
+      feat->vals[i] = 0;
+
+   feat->branchoffset = feat->size;
+   feat->size += SCIP_FEATBRANCH_SIZE;
+
+   return SCIP_OKAY;
+}
+
+/** append the features of the path from the root to a node to the feature vector */
+static
+SCIP_RETCODE featAddPathFeat(
+   SCIP_FEAT*           feat
+   )
+{
+   int i;
+
+   assert(feat != NULL);
+   assert(feat->pathoffset == 0);
+
+   SCIP_ALLOC( BMSreallocMemoryArray(&feat->vals, feat->size + SCIP_FEATPATH_SIZE) );
+   for( i = feat->size; i < feat->size + SCIP_FEATPATH_SIZE; i++ )
+      feat->vals[i] = 0;
+
+   SCIP_ALLOC( BMSallocMemory(&feat->pathstore) );
+   feat->pathstore->paths = NULL;
+   feat->pathstore->npaths = 0;
+   feat->pathstore->pathssize = 0;
+   feat->pathstore->ncollect = PATHMAPSIZE;
+   feat->pathstore->pathmap = NULL;
+   feat->pathstore->nruns = 0;
+   feat->pathstore->pathnodes = NULL;
+   feat->pathstore->pathnodessize = 0;
+   feat->pathstore->nuses = 1;
+
+   feat->pathoffset = feat->size;
+   feat->size += SCIP_FEATPATH_SIZE;
+
+   return SCIP_OKAY;
+}
+
+/** release a path store, freeing it if no feature vector uses it any more */
+static
+void pathstoreRelease(
+   SCIP_PATHSTORE**  store
+   )
+{
+   assert(store != NULL);
+   assert(*store != NULL);
+   assert((*store)->nuses > 0);
+
+   if( --(*store)->nuses == 0 )
+   {
+      BMSfreeMemoryArrayNull(&(*store)->paths);
+      BMSfreeMemoryArrayNull(&(*store)->pathnodes);
+      if( (*store)->pathmap != NULL )
+         SCIPhashmapFree(&(*store)->pathmap);
+      BMSfreeMemory(store);
+   }
+   *store = NULL;
+}
+
+/** create feature vector with the optional families of features selected by opts appended */
+SCIP_RETCODE SCIPfeatCreateExt(
+   SCIP*                scip,
+   SCIP_FEAT**          feat,
+   int                  size,
+   const SCIP_FEATOPTS* opts
+   )
+{
+   assert(opts != NULL);
+
+   SCIP_CALL( SCIPfeatCreate(scip, feat, size) );
+   assert(*feat != NULL);
+
+   if( opts->instfeats )
+   {
+      SCIP_CALL( featAddInstanceFeat(*feat) );
+   }
+   if( opts->branchfeats )
+   {
+      SCIP_CALL( featAddBranchFeat(*feat) );
+   }
+   if( opts->pathfeats )
+   {
+      SCIP_CALL( featAddPathFeat(*feat) );
+   }
+
+   return SCIP_OKAY;
+}
+
+/** let feat use the path records of sharedfeat, e.g., the features of the optimal child and of the other children of
+ *  a node selector, so that the records are kept once; does nothing if the feature vectors have no path features
+ */
+void SCIPfeatSharePaths(
+   SCIP_FEAT*           feat,
+   SCIP_FEAT*           sharedfeat
+   )
+{
+   assert(feat != NULL);
+   assert(sharedfeat != NULL);
+   assert((feat->pathstore == NULL) == (sharedfeat->pathstore == NULL));
+
+   if( feat->pathstore == NULL || feat->pathstore == sharedfeat->pathstore )
+      return;
+
+   pathstoreRelease(&feat->pathstore);
+   feat->pathstore = sharedfeat->pathstore;
+   feat->pathstore->nuses++;
+}
+
+/** add the parameters "<prefix>/instfeats", "<prefix>/branchfeats" and "<prefix>/pathfeats" selecting the optional
+ *  families of features of a node selector or pruner
+ */
+SCIP_RETCODE SCIPfeatAddOptsParams(
+   SCIP*                scip,
+   const char*          prefix,
+   SCIP_FEATOPTS*       opts
+   )
+{
+   char name[SCIP_MAXSTRLEN];
+
+   assert(scip != NULL);
+   assert(prefix != NULL);
+   assert(opts != NULL);
+
+   (void) SCIPsnprintf(name, SCIP_MAXSTRLEN, "%s/instfeats", prefix);
+   SCIP_CALL( SCIPaddBoolParam(scip, name,
+         "append the instance features, computed once after the root LP, to the features of each node?",
+         &opts->instfeats, FALSE, DEFAULT_INSTFEATS, NULL, NULL) );
+   (void) SCIPsnprintf(name, SCIP_MAXSTRLEN, "%s/branchfeats", prefix);
+   SCIP_CALL( SCIPaddBoolParam(scip, name,
+         "append the number and the maxima of pseudocost, inferences and LP distance of the branching bound changes to the features of each node?",
+         &opts->branchfeats, FALSE, DEFAULT_BRANCHFEATS, NULL, NULL) );
+   (void) SCIPsnprintf(name, SCIP_MAXSTRLEN, "%s/pathfeats", prefix);
+   SCIP_CALL( SCIPaddBoolParam(scip, name,
+         "append the lower bound change from the parent, the numbers of up and down branchings and the pseudocost along the path to the features of each node?",
+         &opts->pathfeats, FALSE, DEFAULT_PATHFEATS, NULL, NULL) );
+
+   return SCIP_OKAY;
+}
+
+/** start a new selection round of the memo of branching statistics if the history may have changed since the last
+ *  one, i.e., if a node was activated (which counts its branchings), a bound change was generated (which counts as
+ *  an inference of the last branching variable) or an LP was solved (which updates the pseudocosts)
+ */
+static
+void featUpdateMemo(
+   SCIP*             scip,
+   SCIP_FEAT*        feat
+   )
+{
+   SCIP_Longint nlps;
+   SCIP_Longint nactivatednodes;
+   SCIP_Longint nboundchgs;
+   int i;
+
+   nlps = SCIPgetNLPs(scip);
+   nactivatednodes = scip->stat->nactivatednodes;
+   nboundchgs = scip->stat->nboundchgs;
+   if( nlps == feat->memonlps && nactivatednodes == feat->memonactivatednodes && nboundchgs == feat->memonboundchgs )
+      return;
+
+   feat->memonlps = nlps;
+   feat->memonactivatednodes = nactivatednodes;
+   feat->memonboundchgs = nboundchgs;
+   feat->memoround++;
+
+   if( feat->memo == NULL )
+   {
+      /* the variables are fixed once the tree is searched; the memo is not used if allocation fails */
+      if( BMSallocMemoryArray(&feat->memo, 2 * SCIPgetNVars(scip)) != NULL )
+      {
+         feat->nmemo = 2 * SCIPgetNVars(scip);
+         for( i = 0; i < feat->nmemo; i++ )
+         {
+            feat->memo[i].pscostround = 0;
+            feat->memo[i].infround = 0;
+         }
+      }
+   }
+}
+
+/** returns the memo entry of the variable in the direction, or NULL if the variable is not in the memo */
+static
+SCIP_FEATMEMO* featGetMemo(
+   SCIP_FEAT*        feat,
+   SCIP_VAR*         var,
+   SCIP_BRANCHDIR    dir
+   )
+{
+   int idx;
+
+   idx = 2 * SCIPvarGetProbindex(var) + (int)dir;
+   if( idx < 0 || idx >= feat->nmemo )
+      return NULL;
+
+   return &feat->memo[idx];
+}
+
+/** pseudocost of changing the LP value of the variable by solvaldelta, memoized per direction */
+static
+SCIP_Real featGetPseudocost(
+   SCIP*             scip,
+   SCIP_FEAT*        feat,
+   SCIP_VAR*         var,
+   SCIP_Real         solvaldelta
+   )
+{
+   SCIP_FEATMEMO* memo;
+   SCIP_BRANCHDIR dir;
+
+   dir = solvaldelta >= 0.0 ? SCIP_BRANCHDIR_UPWARDS : SCIP_BRANCHDIR_DOWNWARDS;
+   memo = featGetMemo(feat, var, dir);
+   if( memo == NULL )
+      return SCIPvarGetPseudocost(var, scip->stat, solvaldelta);
+
+   /* the pseudocost is linear in the absolute change for each direction */
+   if( memo->pscostround != feat->memoround )
+   {
+      memo->pscost = SCIPvarGetPseudocost(var, scip->stat, dir == SCIP_BRANCHDIR_UPWARDS ? 1.0 : -1.0);
+      memo->pscostround = feat->memoround;
+   }
+
+   return REALABS(solvaldelta) * memo->pscost;
+}
+
+/** average number of inferences of branching on the variable in the direction, memoized */
+static
+SCIP_Real featGetAvgInferences(
+   SCIP*             scip,
+   SCIP_FEAT*        feat,
+   SCIP_VAR*         var,
+   SCIP_BRANCHDIR    dir
+   )
+{
+   SCIP_FEATMEMO* memo;
+
+   memo = featGetMemo(feat, var, dir);
+   if( memo == NULL )
+      return SCIPvarGetAvgInferences(var, scip->stat, dir);
+
+   if( memo->infround != feat->memoround )
+   {
+      memo->inf = SCIPvarGetAvgInferences(var, scip->stat, dir);
+      memo->infround = feat->memoround;
+   }
+
+   return memo->inf;
+}
+
+/** aggregates over the branching bound changes of a node */
+typedef struct BranchAgg
+{
+   SCIP_Real          sumbounddiff;       /**< sum of the distances of the new bounds to the LP solution */
+   SCIP_Real          sumrootdiff;        /**< sum of the distances of the root LP solution to the LP solution */
+   SCIP_Real          sumpseudocost;      /**< sum of the pseudocosts of the bound changes */
+   SCIP_Real          suminf;             /**< sum of the average inferences in the branching directions */
+   SCIP_Real          maxbounddiff;       /**< maximum absolute distance of a new bound to the LP solution */
+   SCIP_Real          maxpseudocost;      /**< maximum pseudocost of a bound change */
+   SCIP_Real          maxinf;             /**< maximum average inferences in the branching direction */
+   SCIP_BOUNDTYPE     boundtype;          /**< bound type of the first branching bound change */
+   SCIP_BRANCHDIR     branchdirpreferred; /**< preferred branching direction of the first branching variable */
+   int                nbranchings;        /**< number of branching bound changes */
+} BRANCHAGG;
+
+/** aggregate the branching bound changes of the node, e.g., one per branching variable of SOS or multi-aggregated
+ *  branching; they are stored before the inferred bound changes
+ */
+static
+void calcBranchAgg(
+   SCIP*             scip,
+   SCIP_NODE*        node,
+   SCIP_FEAT*        feat,
+   BRANCHAGG*        agg
+   )
+{
+   SCIP_BOUNDCHG* boundchgs;
+   SCIP_Bool haslp;
+   int nboundchgs;
+   int i;
+
+   agg->sumbounddiff = 0.0;
+   agg->sumrootdiff = 0.0;
+   agg->sumpseudocost = 0.0;
+   agg->suminf = 0.0;
+   agg->maxbounddiff = 0.0;
+   agg->maxpseudocost = 0.0;
+   agg->maxinf = 0.0;
+   agg->boundtype = SCIP_BOUNDTYPE_LOWER;
+   agg->branchdirpreferred = SCIP_BRANCHDIR_AUTO;
+   agg->nbranchings = 0;
+
+   if( node->domchg == NULL )
+      return;
+
+   boundchgs = node->domchg->domchgbound.boundchgs;
+   nboundchgs = (int)node->domchg->domchgbound.nboundchgs;
+   haslp = SCIPtreeHasFocusNodeLP(scip->tree);
+   featUpdateMemo(scip, feat);
+
+   for( i = 0; i < nboundchgs && boundchgs[i].boundchgtype == SCIP_BOUNDCHGTYPE_BRANCHING; i++ )
+   {
+      SCIP_VAR* branchvar = boundchgs[i].var;
+      SCIP_Real varsol = SCIPvarGetSol(branchvar, haslp);
+      SCIP_Real bounddiff = boundchgs[i].newbound - varsol;
+      SCIP_Real pseudocost = featGetPseudocost(scip, feat, branchvar, bounddiff);
+      SCIP_Real inf = featGetAvgInferences(scip, feat, branchvar,
+         boundchgs[i].boundtype == SCIP_BOUNDTYPE_LOWER ? SCIP_BRANCHDIR_UPWARDS : SCIP_BRANCHDIR_DOWNWARDS)
+         / (SCIP_Real)feat->maxdepth;
+
+      if( i == 0 )
+      {
+         agg->boundtype = (SCIP_BOUNDTYPE)boundchgs[0].boundtype;
+         agg->branchdirpreferred = SCIPvarGetBranchDirection(branchvar);
+      }
+
+      agg->sumbounddiff += bounddiff;
+      agg->sumrootdiff += SCIPvarGetRootSol(branchvar) - varsol;
+      agg->sumpseudocost += pseudocost;
+      agg->suminf += inf;
+      agg->maxbounddiff = MAX(agg->maxbounddiff, REALABS(bounddiff));
+      agg->maxpseudocost = MAX(agg->maxpseudocost, pseudocost);
+      agg->maxinf = MAX(agg->maxinf, inf);
+      agg->nbranchings++;
+   }
+
+   if( feat->branchoffset > 0 )
+   {
+      SCIP_Real* vals = &feat->vals[feat->branchoffset];
+
+      vals[SCIP_FEATBRANCH_NBRANCHINGS] = agg->nbranchings;
+      vals[SCIP_FEATBRANCH_MAXPSEUDOCOST] = agg->maxpseudocost;
+      vals[SCIP_FEATBRANCH_MAXINF] = agg->maxinf;
+      vals[SCIP_FEATBRANCH_MAXBOUNDLPDIFF] = agg->maxbounddiff;
+   }
+}
+
+/** drop the path records of the nodes that are no longer open, keeping those of the current node and of the open
+ *  nodes, whose descendants are extended from them
+ */
+static
+SCIP_RETCODE pathstoreCollect(
+   SCIP*             scip,
+   SCIP_PATHSTORE*   store
+   )
+{
+   SCIP_NODE** lists[3];
+   int nlists[3];
+   SCIP_PATHRECORD* kept;
+   SCIP_NODE** keptnodes;
+   SCIP_NODE* current;
+   int nkept;
+   int l;
+   int i;
+
+   SCIP_CALL( SCIPgetOpenNodesData(scip, &lists[0], &lists[1], &lists[2], &nlists[0], &nlists[1], &nlists[2]) );
+   current = SCIPgetCurrentNode(scip);
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &kept, nlists[0] + nlists[1] + nlists[2] + 1) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &keptnodes, nlists[0] + nlists[1] + nlists[2] + 1) );
+
+   nkept = 0;
+   for( l = -1; l < 3; l++ )
+   {
+      for( i = 0; i < (l < 0 ? 1 : nlists[l]); i++ )
+      {
+         SCIP_NODE* node = l < 0 ? current : lists[l][i];
+
+         if( node != NULL && SCIPhashmapExists(store->pathmap, (void*)(size_t)SCIPnodeGetNumber(node)) )
+         {
+            kept[nkept] = store->paths[(size_t)SCIPhashmapGetImage(store->pathmap,
+                  (void*)(size_t)SCIPnodeGetNumber(node)) - 1];
+            keptnodes[nkept++] = node;
+         }
+      }
+   }
+
+   SCIP_CALL( SCIPhashmapRemoveAll(store->pathmap) );
+   for( i = 0; i < nkept; i++ )
+   {
+      store->paths[i] = kept[i];
+      SCIP_CALL( SCIPhashmapInsert(store->pathmap, (void*)(size_t)SCIPnodeGetNumber(keptnodes[i]),
+            (void*)(size_t)(i + 1)) );
+   }
+   SCIPdebugMessage("kept %d of %d path records\n", nkept, store->npaths);
+   store->npaths = nkept;
+   store->ncollect = MAX(2 * nkept, PATHMAPSIZE);
+
+   SCIPfreeBufferArray(scip, &keptnodes);
+   SCIPfreeBufferArray(scip, &kept);
+
+   return SCIP_OKAY;
+}
+
+/** get the path record of the node; records are created once per node from the record of its parent and the branching
+ *  bound changes of the node, so that the ancestors are only visited if they have no record (yet or any more)
+ */
+static
+SCIP_RETCODE featGetPathRecord(
+   SCIP*             scip,
+   SCIP_FEAT*        feat,
+   SCIP_NODE*        node,
+   SCIP_PATHRECORD*  record
+   )
+{
+   SCIP_PATHSTORE* store = feat->pathstore;
+   SCIP_NODE* ancestor;
+   int nnodes;
+
+   assert(store != NULL);
+
+   if( store->pathmap == NULL )
+   {
+      SCIP_CALL( SCIPhashmapCreate(&store->pathmap, SCIPblkmem(scip), SCIPcalcHashtableSize(PATHMAPSIZE)) );
+      store->nruns = SCIPgetNRuns(scip);
+   }
+   else if( store->nruns != SCIPgetNRuns(scip) )
+   {
+      /* a restart numbers the nodes from the root again, so the records of the previous run would be found for other
+       * nodes
+       */
+      SCIP_CALL( SCIPhashmapRemoveAll(store->pathmap) );
+      store->npaths = 0;
+      store->ncollect = PATHMAPSIZE;
+      store->nruns = SCIPgetNRuns(scip);
+   }
+   else if( store->npaths >= store->ncollect )
+   {
+      SCIP_CALL( pathstoreCollect(scip, store) );
+   }
+
+   /* collect the ancestors without record, starting at the node */
+   nnodes = 0;
+   ancestor = node;
+   while( ancestor != NULL && SCIPnodeGetDepth(ancestor) > 0
+      && !SCIPhashmapExists(store->pathmap, (void*)(size_t)SCIPnodeGetNumber(ancestor)) )
+   {
+      if( nnodes == store->pathnodessize )
+      {
+         store->pathnodessize = MAX(2 * store->pathnodessize, 64);
+         SCIP_ALLOC( BMSreallocMemoryArray(&store->pathnodes, store->pathnodessize) );
+      }
+      store->pathnodes[nnodes++] = ancestor;
+      ancestor = SCIPnodeGetParent(ancestor);
+   }
+
+   if( ancestor == NULL || SCIPnodeGetDepth(ancestor) == 0 )
+   {
+      record->pscost = 0.0;
+      record->nup = 0;
+      record->ndown = 0;
+   }
+   else
+      *record = store->paths[(size_t)SCIPhashmapGetImage(store->pathmap, (void*)(size_t)SCIPnodeGetNumber(ancestor)) - 1];
+
+   /* extend the record down to the node */
+   while( nnodes > 0 )
+   {
+      SCIP_NODE* pathnode = store->pathnodes[--nnodes];
+
+      if( pathnode->domchg != NULL )
+      {
+         SCIP_BOUNDCHG* boundchgs = pathnode->domchg->domchgbound.boundchgs;
+         int nboundchgs = (int)pathnode->domchg->domchgbound.nboundchgs;
+         int i;
+
+         for( i = 0; i < nboundchgs && boundchgs[i].boundchgtype == SCIP_BOUNDCHGTYPE_BRANCHING; i++ )
+         {
+            if( boundchgs[i].boundtype == SCIP_BOUNDTYPE_LOWER )
+               record->nup++;
+            else
+               record->ndown++;
+            record->pscost += featGetPseudocost(scip, feat, boundchgs[i].var,
+               boundchgs[i].newbound - SCIPvarGetRootSol(boundchgs[i].var));
+         }
+      }
+
+      if( store->npaths == store->pathssize )
+      {
+         store->pathssize = MAX(2 * store->pathssize, 64);
+         SCIP_ALLOC( BMSreallocMemoryArray(&store->paths, store->pathssize) );
+      }
+      store->paths[store->npaths++] = *record;
+      SCIP_CALL( SCIPhashmapInsert(store->pathmap, (void*)(size_t)SCIPnodeGetNumber(pathnode),
+            (void*)(size_t)store->npaths) );
+   }
+
+   return SCIP_OKAY;
+}
+
+/** calculate the path features of the node */
+static
+SCIP_RETCODE calcPathFeat(
+   SCIP*             scip,
+   SCIP_NODE*        node,
+   SCIP_FEAT*        feat,
+   SCIP_Real         rootlowerbound
+   )
+{
+   SCIP_PATHRECORD record;
+   SCIP_NODE* parent;
+   SCIP_Real* vals;
+
+   assert(feat->pathoffset > 0);
+
+   SCIP_CALL( featGetPathRecord(scip, feat, node, &record) );
+
+   vals = &feat->vals[feat->pathoffset];
+   parent = SCIPnodeGetParent(node);
+   vals[SCIP_FEATPATH_PARENTBOUNDDELTA] = parent == NULL ? 0.0
+      : (SCIPnodeGetLowerbound(node) - SCIPnodeGetLowerbound(parent)) / rootlowerbound;
+   vals[SCIP_FEATPATH_NUP] = record.nup / (SCIP_Real)feat->maxdepth;
+   vals[SCIP_FEATPATH_NDOWN] = record.ndown / (SCIP_Real)feat->maxdepth;
+   vals[SCIP_FEATPATH_PSEUDOCOST] = record.pscost / rootlowerbound;
+
+   return SCIP_OKAY;
+}
+
+SCIP_RETCODE SCIPcalcProblemStats(
+   SCIP*             scip,
+   SCIP_Real*        vals
+   )
+{
+   SCIP_VAR** vars;
+   SCIP_CONS** conss;
+   SCIP_Real nnz;
+   SCIP_Bool success;
+   int nobjnz;
+   int nvars;
+   int nconss;
+   int nconsvars;
+   int i;
+
+   assert(scip != NULL);
+   assert(vals != NULL);
+
+   vars = SCIPgetVars(scip);
+   nvars = SCIPgetNVars(scip);
+   conss = SCIPgetConss(scip);
+   nconss = SCIPgetNConss(scip);
+
+   for( i = 0; i < SCIP_FEATINST_NPROBSTATS; i++ )
+      vals[i] = 0.0;
+
+   vals[SCIP_FEATINST_NVARS] = log10(1.0 + nvars);
+   vals[SCIP_FEATINST_NCONSS] = log10(1.0 + nconss);
+   if( nvars == 0 )
+      return SCIP_OKAY;
+
+   vals[SCIP_FEATINST_BINFRAC] = (SCIP_Real)SCIPgetNBinVars(scip) / nvars;
+   vals[SCIP_FEATINST_INTFRAC] = (SCIP_Real)SCIPgetNIntVars(scip) / nvars;
+   vals[SCIP_FEATINST_CONTFRAC] = (SCIP_Real)(SCIPgetNImplVars(scip) + SCIPgetNContVars(scip)) / nvars;
+
+   /* constraint matrix density; constraints that do not report their variables are left out */
+   nnz = 0.0;
+   for( i = 0; i < nconss; i++ )
+   {
+      SCIP_CALL( SCIPgetConsNVars(scip, conss[i], &nconsvars, &success) );
+      if( success )
+         nnz += nconsvars;
+   }
+   if( nconss > 0 )
+      vals[SCIP_FEATINST_DENSITY] = nnz / ((SCIP_Real)nconss * nvars);
+
+   nobjnz = 0;
+   for( i = 0; i < nvars; i++ )
+   {
+      if( !SCIPisZero(scip, SCIPvarGetObj(vars[i])) )
+         nobjnz++;
+   }
+   vals[SCIP_FEATINST_OBJDENSITY] = (SCIP_Real)nobjnz / nvars;
+
+   return SCIP_OKAY;
+}
+
+/** calculate the instance features of the presolved problem and its root LP, and set the normalizers */
+static
+SCIP_RETCODE calcInstanceFeat(
+   SCIP*             scip,
+   SCIP_FEAT*        feat
+   )
+{
+   SCIP_Real* vals;
+   SCIP_VAR** vars;
+   SCIP_Real sumobj;
+   SCIP_Real sumsqrobj;
+   int nobjnz;
+   int nfrac;
+   int nvars;
+   int i;
+
+   assert(feat->instoffset > 0);
+
+   vals = &feat->vals[feat->instoffset];
+   vars = SCIPgetVars(scip);
+   nvars = SCIPgetNVars(scip);
+
+   SCIP_CALL( SCIPcalcProblemStats(scip, vals) );
+
+   /* objective: coefficient of variation of the absolute values of the nonzeros */
+   sumobj = 0.0;
+   sumsqrobj = 0.0;
+   nobjnz = 0;
+   nfrac = 0;
+   for( i = 0; i < nvars; i++ )
+   {
+      SCIP_Real obj = REALABS(SCIPvarGetObj(vars[i]));
+
+      if( !SCIPsetIsZero(scip->set, obj) )
+      {
+         sumobj += obj;
+         sumsqrobj += obj * obj;
+         nobjnz++;
+      }
+      if( SCIPvarGetType(vars[i]) <= SCIP_VARTYPE_INTEGER && !SCIPsetIsFeasIntegral(scip->set, SCIPvarGetRootSol(vars[i])) )
+         nfrac++;
+   }
+   if( nobjnz > 0 && sumobj > 0.0 )
+      vals[SCIP_FEATINST_OBJVARIATION] = sqrt(MAX(sumsqrobj / nobjnz - SQR(sumobj / nobjnz), 0.0)) / (sumobj / nobjnz);
+
+   /* root LP: fractional integer variables and iterations */
+   if( SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip) > 0 )
+      vals[SCIP_FEATINST_ROOTFRAC] = (SCIP_Real)nfrac / (SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
+   vals[SCIP_FEATINST_ROOTITERS] = log10(1.0 + SCIPgetNRootLPIterations(scip));
+
+   feat->rootlpobj = scip->stat->rootlowerbound;
+   feat->sumobjcoeff = sumobj;
+   feat->nconstrs = SCIPgetNConss(scip);
+   feat->instdone = TRUE;
 
    return SCIP_OKAY;
 }
@@ -79,6 +770,9 @@ SCIP_RETCODE SCIPfeatFree(
    assert(feat != NULL);
    assert(*feat != NULL);
    BMSfreeMemoryArray(&(*feat)->vals);
+   BMSfreeMemoryArrayNull(&(*feat)->memo);
+   if( (*feat)->pathstore != NULL )
+      pathstoreRelease(&(*feat)->pathstore);
    SCIPfreeBlockMemory(scip, feat);
 
    return SCIP_OKAY;
@@ -95,22 +789,17 @@ void SCIPcalcNodepruFeat(
    SCIP_Real upperbound;
    SCIP_Bool upperboundinf;
    SCIP_Real rootlowerbound;
-   SCIP_VAR* branchvar;
-   SCIP_BOUNDCHG* boundchgs;
-   SCIP_BRANCHDIR branchdirpreferred;
-   SCIP_Real branchbound;
-   SCIP_Bool haslp;
-   SCIP_Real varsol;
-   SCIP_Real varrootsol;
+   BRANCHAGG agg;
 
    assert(node != NULL);
    assert(SCIPnodeGetDepth(node) != 0);
    assert(feat != NULL);
    assert(feat->maxdepth != 0);
 
-   boundchgs = node->domchg->domchgbound.boundchgs;
-   assert(boundchgs != NULL);
-   assert(boundchgs[0].boundchgtype == SCIP_BOUNDCHGTYPE_BRANCHING);
+   if( feat->instoffset > 0 && !feat->instdone )
+   {
+      SCIP_CALL_ABORT( calcInstanceFeat(scip, feat) );
+   }
 
    feat->depth = SCIPnodeGetDepth(node);
 
@@ -129,16 +818,12 @@ void SCIPcalcNodepruFeat(
       rootlowerbound = 0.0001;
    assert(!SCIPsetIsInfinity(scip->set, rootlowerbound));
 
-   /* currently only support branching on one variable */
-   branchvar = boundchgs[0].var; 
-   branchbound = boundchgs[0].newbound;
-   branchdirpreferred = SCIPvarGetBranchDirection(branchvar);
-
-   haslp = SCIPtreeHasFocusNodeLP(scip->tree);
-   varsol = SCIPvarGetSol(branchvar, haslp);
-   varrootsol = SCIPvarGetRootSol(branchvar);
-
-   feat->boundtype = boundchgs[0].boundtype;
+   calcBranchAgg(scip, node, feat, &agg);
+   feat->boundtype = agg.boundtype;
+   if( feat->pathoffset > 0 )
+   {
+      SCIP_CALL_ABORT( calcPathFeat(scip, node, feat, rootlowerbound) );
+   }
 
    /* calculate features */
    /* global features */
@@ -169,22 +854,17 @@ void SCIPcalcNodepruFeat(
       feat->vals[SCIP_FEATNODEPRU_RELATIVEESTIMATE] = (SCIPnodeGetEstimate(node) - lowerbound)/ (upperbound - lowerbound);
    }
 
-   /* branch var features */
-   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_BOUNDLPDIFF] = branchbound - varsol;
-   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_ROOTLPDIFF] = varrootsol - varsol;
+   /* branch var features, summed over the branching bound changes */
+   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_BOUNDLPDIFF] = agg.sumbounddiff;
+   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_ROOTLPDIFF] = agg.sumrootdiff;
 
-   if( branchdirpreferred == SCIP_BRANCHDIR_DOWNWARDS )
+   if( agg.branchdirpreferred == SCIP_BRANCHDIR_DOWNWARDS )
       feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_PRIO_DOWN] = 1;
-   else if(branchdirpreferred == SCIP_BRANCHDIR_UPWARDS ) 
+   else if( agg.branchdirpreferred == SCIP_BRANCHDIR_UPWARDS )
       feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_PRIO_UP] = 1;
 
-   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_PSEUDOCOST] = SCIPvarGetPseudocost(branchvar, scip->stat, branchbound - varsol);
-   /*fprintf(stderr, "%d cost: %f, varobj: %f", (int)SCIP_FEATNODEPRU_BRANCHVAR_PSEUDOCOST, SCIPvarGetPseudocost(branchvar, scip->stat, branchbound - varsol), varobj);*/
-
-   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_INF] = 
-      feat->boundtype == SCIP_BOUNDTYPE_LOWER ? 
-      SCIPvarGetAvgInferences(branchvar, scip->stat, SCIP_BRANCHDIR_UPWARDS) / (SCIP_Real)feat->maxdepth : 
-      SCIPvarGetAvgInferences(branchvar, scip->stat, SCIP_BRANCHDIR_DOWNWARDS) / (SCIP_Real)feat->maxdepth;
+   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_PSEUDOCOST] = agg.sumpseudocost;
+   feat->vals[SCIP_FEATNODEPRU_BRANCHVAR_INF] = agg.suminf;
 }
 
 /** calculate feature values for the node selector of this node */
@@ -199,23 +879,18 @@ void SCIPcalcNodeselFeat(
    SCIP_Real rootlowerbound;
    SCIP_Real lowerbound;            /**< global lower bound */
    SCIP_Real upperbound;           /**< global upper bound */
-   SCIP_VAR* branchvar;
-   SCIP_BOUNDCHG* boundchgs;
-   SCIP_BRANCHDIR branchdirpreferred;
-   SCIP_Real branchbound;
-   SCIP_Bool haslp;
    SCIP_Bool upperboundinf;
-   SCIP_Real varsol;
-   SCIP_Real varrootsol;
+   BRANCHAGG agg;
 
    assert(node != NULL);
    assert(SCIPnodeGetDepth(node) != 0);
    assert(feat != NULL);
    assert(feat->maxdepth != 0);
 
-   boundchgs = node->domchg->domchgbound.boundchgs;
-   assert(boundchgs != NULL);
-   assert(boundchgs[0].boundchgtype == SCIP_BOUNDCHGTYPE_BRANCHING);
+   if( feat->instoffset > 0 && !feat->instdone )
+   {
+      SCIP_CALL_ABORT( calcInstanceFeat(scip, feat) );
+   }
 
    /* extract necessary information */
    nodetype = SCIPnodeGetType(node);
@@ -254,17 +929,12 @@ void SCIPcalcNodeselFeat(
    feat->vals[SCIP_FEATNODESEL_PLUNGEDEPTH] = SCIPgetPlungeDepth(scip);
    feat->vals[SCIP_FEATNODESEL_RELATIVEDEPTH] = (SCIP_Real)feat->depth / (SCIP_Real)feat->maxdepth * 10.0;
 
-
-   /* currently only support branching on one variable */
-   branchvar = boundchgs[0].var; 
-   branchbound = boundchgs[0].newbound;
-   branchdirpreferred = SCIPvarGetBranchDirection(branchvar);
-
-   haslp = SCIPtreeHasFocusNodeLP(scip->tree);
-   varsol = SCIPvarGetSol(branchvar, haslp);
-   varrootsol = SCIPvarGetRootSol(branchvar);
-
-   feat->boundtype = boundchgs[0].boundtype;
+   calcBranchAgg(scip, node, feat, &agg);
+   feat->boundtype = agg.boundtype;
+   if( feat->pathoffset > 0 )
+   {
+      SCIP_CALL_ABORT( calcPathFeat(scip, node, feat, rootlowerbound) );
+   }
 
    /* calculate features */
    feat->vals[SCIP_FEATNODESEL_LOWERBOUND] = 
@@ -283,129 +953,19 @@ void SCIPcalcNodeselFeat(
    else if( nodetype == SCIP_NODETYPE_LEAF )
       feat->vals[SCIP_FEATNODESEL_TYPE_LEAF] = 1;
 
-   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_BOUNDLPDIFF] = branchbound - varsol;
-   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_ROOTLPDIFF] = varrootsol - varsol;
+   /* branch var features, summed over the branching bound changes */
+   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_BOUNDLPDIFF] = agg.sumbounddiff;
+   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_ROOTLPDIFF] = agg.sumrootdiff;
 
-   if( branchdirpreferred == SCIP_BRANCHDIR_DOWNWARDS )
+   if( agg.branchdirpreferred == SCIP_BRANCHDIR_DOWNWARDS )
       feat->vals[SCIP_FEATNODESEL_BRANCHVAR_PRIO_DOWN] = 1;
-   else if(branchdirpreferred == SCIP_BRANCHDIR_UPWARDS ) 
+   else if( agg.branchdirpreferred == SCIP_BRANCHDIR_UPWARDS )
       feat->vals[SCIP_FEATNODESEL_BRANCHVAR_PRIO_UP] = 1;
 
-   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_PSEUDOCOST] = SCIPvarGetPseudocost(branchvar, scip->stat, branchbound - varsol);
-
-   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_INF] = 
-      feat->boundtype == SCIP_BOUNDTYPE_LOWER ? 
-      SCIPvarGetAvgInferences(branchvar, scip->stat, SCIP_BRANCHDIR_UPWARDS) / (SCIP_Real)feat->maxdepth : 
-      SCIPvarGetAvgInferences(branchvar, scip->stat, SCIP_BRANCHDIR_DOWNWARDS) / (SCIP_Real)feat->maxdepth;
-
-
-}
-
-/** write feature vector diff (feat1 - feat2) in libsvm format */
-void SCIPfeatDiffLIBSVMPrint(
-   SCIP*             scip,
-   FILE*             file,
-   FILE*             wfile,
-   SCIP_FEAT*        feat1,
-   SCIP_FEAT*        feat2,
-   int               label,
-   SCIP_Bool         negate
-   )
-{
-   int size;
-   int i;
-   int offset1;
-   int offset2;
-   SCIP_Real weight;
-
-   assert(scip != NULL);
-   assert(feat1 != NULL);
-   assert(feat2 != NULL);
-   assert(feat1->depth != 0);
-   assert(feat2->depth != 0);
-   assert(feat1->size == feat2->size);
-
-   weight = SCIPfeatGetWeight(feat1);
-   SCIPinfoMessage(scip, wfile, "%f\n", weight);  
-
-   if( negate )
-   {
-      SCIP_FEAT* tmp = feat1;
-      feat1 = feat2;
-      feat2 = tmp;
-      label = -1 * label;
-   }
-
-   size = SCIPfeatGetSize(feat1);
-   offset1 = SCIPfeatGetOffset(feat1);
-   offset2 = SCIPfeatGetOffset(feat2);
-
-   SCIPinfoMessage(scip, file, "%d ", label);  
-
-   if( offset1 == offset2 )
-   {
-      for( i = 0; i < size; i++ )
-         SCIPinfoMessage(scip, file, "%d:%f ", i + offset1 + 1, feat1->vals[i] - feat2->vals[i]);
-   }
-   else
-   {
-      /* libsvm requires sorted indices, write smaller indices first */
-      if( offset1 < offset2 )
-      {
-         /* feat1 */
-         for( i = 0; i < size; i++ )
-            SCIPinfoMessage(scip, file, "%d:%f ", i + offset1 + 1, feat1->vals[i]);
-         /* -feat2 */
-         for( i = 0; i < size; i++ )
-            SCIPinfoMessage(scip, file, "%d:%f ", i + offset2 + 1, -feat2->vals[i]);
-      }
-      else
-      {
-         /* -feat2 */
-         for( i = 0; i < size; i++ )
-            SCIPinfoMessage(scip, file, "%d:%f ", i + offset2 + 1, -feat2->vals[i]);
-         /* feat1 */
-         for( i = 0; i < size; i++ )
-            SCIPinfoMessage(scip, file, "%d:%f ", i + offset1 + 1, feat1->vals[i]);
-      }
-   }
-
-   SCIPinfoMessage(scip, file, "\n");
-}
-
-/** write feature vector in libsvm format */
-void SCIPfeatLIBSVMPrint(
-   SCIP*             scip,
-   FILE*             file,
-   FILE*             wfile,
-   SCIP_FEAT*        feat,
-   int               label
-   )
-{
-   int size;
-   int i;
-   int offset;
-   SCIP_Real weight;
-
-   assert(scip != NULL);
-   assert(feat != NULL);
-   assert(feat->depth != 0);
-
-   weight = SCIPfeatGetWeight(feat);
-   SCIPinfoMessage(scip, wfile, "%f\n", weight);  
-
-   size = SCIPfeatGetSize(feat);
-   offset = SCIPfeatGetOffset(feat);
-
-   SCIPinfoMessage(scip, file, "%d ", label);  
-
-   for( i = 0; i < size; i++ )
-      SCIPinfoMessage(scip, file, "%d:%f ", i + offset + 1, feat->vals[i]);
-
-   SCIPinfoMessage(scip, file, "\n");
+   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_PSEUDOCOST] = agg.sumpseudocost;
+   feat->vals[SCIP_FEATNODESEL_BRANCHVAR_INF] = agg.suminf;
 }
 
-
 /*
  * simple functions implemented as defines
  */
@@ -497,6 +1057,7 @@ int SCIPfeatGetOffset(
    )
 {
    assert(feat != NULL);
-   return (feat->size * 2) * (feat->depth / (feat->maxdepth / 10)) + (feat->size * (int)feat->boundtype);
+   /* depth deciles, or single depths if the tree is less than 10 deep */
+   return (feat->size * 2) * (feat->depth / MAX(feat->maxdepth / 10, 1)) + (feat->size * (int)feat->boundtype);
 }
 
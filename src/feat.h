@@ -21,26 +21,16 @@
 extern "C" {
 #endif
 
-/** write feature vector in libsvm format */
-extern
-void SCIPfeatLIBSVMPrint(
-   SCIP*             scip,
-   FILE*             file,
-   FILE*             wfile,
-   SCIP_FEAT*        feat,
-   int               label
-   );
-
-/** write feature vector diff (feat1 - feat2) in libsvm format */
+/** calculate the size and structure statistics of the problem, the first SCIP_FEATINST_NPROBSTATS instance features
+ *  (see SCIP_FEATINST): the numbers of variables and constraints (log10(1 + n)), the fractions of binary, integer and
+ *  continuous (including implicit integer) variables, the density of the constraint matrix and the fraction of
+ *  variables with a nonzero objective coefficient; they need no solve, so they also make up the fingerprint of a
+ *  problem (see polindex.h)
+ */
 extern
-void SCIPfeatDiffLIBSVMPrint(
+SCIP_RETCODE SCIPcalcProblemStats(
    SCIP*             scip,
-   FILE*             file,
-   FILE*             wfile,
-   SCIP_FEAT*        feat1,
-   SCIP_FEAT*        feat2,
-   int               label,
-   SCIP_Bool         negate
+   SCIP_Real*        vals
    );
 
 /** calculate feature values for the node pruner of this node */
@@ -79,6 +69,34 @@ SCIP_RETCODE SCIPfeatCreate(
    int                  featsize
    );
 
+/** create feature vector with the optional families of features selected by opts appended */
+extern
+SCIP_RETCODE SCIPfeatCreateExt(
+   SCIP*                scip,
+   SCIP_FEAT**          feat,
+   int                  featsize,
+   const SCIP_FEATOPTS* opts
+   );
+
+/** let feat use the path records of sharedfeat, so that the records are kept once; does nothing if the feature vectors
+ *  have no path features
+ */
+extern
+void SCIPfeatSharePaths(
+   SCIP_FEAT*           feat,
+   SCIP_FEAT*           sharedfeat
+   );
+
+/** add the parameters "<prefix>/instfeats", "<prefix>/branchfeats" and "<prefix>/pathfeats" selecting the optional
+ *  families of features of a node selector or pruner
+ */
+extern
+SCIP_RETCODE SCIPfeatAddOptsParams(
+   SCIP*                scip,
+   const char*          prefix,
+   SCIP_FEATOPTS*       opts
+   );
+
 /** copy feature vector value */
 extern
 void SCIPfeatCopy(
@@ -99,7 +117,7 @@ SCIP_RETCODE SCIPfeatFree(
  * speed up the algorithms.
  */
 
-#define SCIPfeatGetOffset(feat)     (feat->size * 2) * (feat->depth / (feat->maxdepth / 10)) + (feat->size * (int)feat->boundtype)
+#define SCIPfeatGetOffset(feat)     (feat->size * 2) * (feat->depth / MAX(feat->maxdepth / 10, 1)) + (feat->size * (int)feat->boundtype)
 
 #endif
 
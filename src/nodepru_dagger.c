@@ -18,8 +18,11 @@
 #include <string.h>
 #include "nodepru_dagger.h"
 #include "nodepru_oracle.h"
+#include "nodepru_policy.h"
 #include "nodesel_oracle.h"
 #include "feat.h"
+#include "trj.h"
+#include "coldstore.h"
 #include "policy.h"
 #include "struct_policy.h"
 #include "scip/sol.h"
@@ -34,6 +37,16 @@
 #define NODEPRU_MEMSAVEPRIORITY 0
 
 #define DEFAULT_FILENAME        ""
+#define DEFAULT_WEIGHTSCHEME    'd'          /**< weighting scheme of examples (see SCIP_TRJ_WEIGHTSCHEMES) */
+#define DEFAULT_DEDUPQUANT      0.0          /**< quantization step of features for merging duplicate examples (0: off) */
+#define DEFAULT_MAXLEAVES       0            /**< maximum number of open leaves before eviction (0: no limit) */
+#define DEFAULT_MEMLIMIT        0.0          /**< maximum memory used in MB before eviction (0: no limit) */
+#define DEFAULT_EVICTFRAC       0.1          /**< fraction of the leaves evicted when the budget is exceeded */
+#define DEFAULT_SOFTPRUNE       FALSE        /**< park pruned nodes in a cold store instead of deleting them? */
+#define DEFAULT_COLDNODES       1000         /**< node limit of the sub-SCIP revisiting a parked node */
+#define DEFAULT_THRESHOLD       0.0          /**< nodes are pruned if their (calibrated) policy score exceeds it */
+#define DEFAULT_THRESHOLDSLOPE  0.0          /**< change of the threshold from the root to the maximum depth */
+#define DEFAULT_SAFEGAP         -1.0         /**< nodes within this relative gap of the incumbent are kept (<0: off) */
 
 /*
  * Data structures
@@ -47,18 +60,44 @@ struct SCIP_NodepruData
    char*              polfname;           /**< name of the solution file */
    SCIP_POLICY*       policy;
    char*              trjfname;           /**< name of the trajectory file */
-   FILE*              wfile;
-   FILE*              trjfile;
+   SCIP_TRJ*          trj;                /**< trajectory examples are written to */
+   char               weightscheme;       /**< weighting scheme of examples */
+   SCIP_Real          dedupquant;         /**< quantization step of features for merging duplicate examples */
    SCIP_FEAT*         feat;
    SCIP_Bool          checkopt;           /**< need to check node optimality? (don't need to if node selector is oracle or dagger */
    int                nprunes;            /**< number of nodes pruned */
    int                nnodes;             /**< number of nodes checked */
    int                nfalsepos;           /**< number of optimal nodes pruned */
    int                nfalseneg;           /**< number of non-optimal nodes not pruned */
+   int                maxleaves;          /**< maximum number of open leaves before eviction (0: no limit) */
+   SCIP_Real          memlimit;           /**< maximum memory used in MB before eviction (0: no limit) */
+   SCIP_Real          evictfrac;          /**< fraction of the leaves evicted when the budget is exceeded */
+   int                nevicted;           /**< number of leaves evicted */
+   int                memleaves;          /**< budget of leaves set when the memory limit was exceeded, or 0 */
+   SCIP_Real          memevicted;         /**< memory used when the budget of leaves was set, or 0 */
+   int                nevictedopt;        /**< number of optimal leaves evicted */
+   SCIP_Bool          softprune;          /**< park pruned nodes in a cold store instead of deleting them? */
+   SCIP_Longint       coldnodes;          /**< node limit of the sub-SCIP revisiting a parked node */
+   SCIP_COLDSTORE*    coldstore;          /**< store of parked nodes, or NULL */
+   char*              calibfname;         /**< name of the calibration file */
+   SCIP_Real          threshold;          /**< nodes are pruned if their (calibrated) policy score exceeds it */
+   SCIP_Real          thresholdslope;     /**< change of the threshold from the root to the maximum depth */
+   SCIP_Real          safegap;            /**< nodes within this relative gap of the incumbent are kept (<0: off) */
    unsigned int       randseed;
 
+   SCIP_FEATOPTS      featopts;           /**< optional families of features appended to the node features */
 };
 
+SCIP_COLDSTORE* SCIPnodeprudaggerGetColdstore(
+   SCIP_NODEPRU*         nodepru
+   )
+{
+   assert(nodepru != NULL);
+   assert(strcmp(SCIPnodepruGetName(nodepru), NODEPRU_NAME) == 0);
+
+   return SCIPnodepruGetData(nodepru)->coldstore;
+}
+
 void SCIPnodeprudaggerPrintStatistics(
    SCIP*                 scip,
    SCIP_NODEPRU*         nodepru,
@@ -81,6 +120,10 @@ void SCIPnodeprudaggerPrintStatistics(
          "  FP pruned        : %d/%d\n", nodeprudata->nfalsepos, nodeprudata->nnodes);
    SCIPmessageFPrintInfo(scip->messagehdlr, file,
          "  FN pruned        : %d/%d\n", nodeprudata->nfalseneg, nodeprudata->nnodes);
+   SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  opt evicted      : %d/%d\n", nodeprudata->nevictedopt, nodeprudata->nevicted);
+   if( nodeprudata->coldstore != NULL )
+      SCIPcoldstorePrintStatistics(scip, nodeprudata->coldstore, file);
    SCIPmessageFPrintInfo(scip->messagehdlr, file,
          "  pruning time     : %10.2f\n", SCIPnodepruGetTime(nodepru));
 }
@@ -108,27 +151,32 @@ SCIP_DECL_NODEPRUINIT(nodepruInitDagger)
    /* read policy */
    SCIP_CALL( SCIPpolicyCreate(scip, &nodeprudata->policy) );
    assert(nodeprudata->polfname != NULL);
-   SCIP_CALL( SCIPreadLIBSVMPolicy(scip, nodeprudata->polfname, &nodeprudata->policy) );
-   assert(nodeprudata->policy->weights != NULL);
-
-   /* open trajectory file for writing */
-   /* open in appending mode for writing training file from multiple problems */
-   nodeprudata->trjfile = NULL;
-   if( nodeprudata->trjfname != NULL )
+   SCIP_CALL( SCIPreadPolicy(scip, nodeprudata->polfname, &nodeprudata->policy) );
+   if( nodeprudata->calibfname != NULL && nodeprudata->calibfname[0] != '\0' )
    {
-      char wfname[SCIP_MAXSTRLEN];
-      strcpy(wfname, nodeprudata->trjfname);
-      strcat(wfname, ".weight");
-      nodeprudata->wfile = fopen(wfname, "a");
-      nodeprudata->trjfile = fopen(nodeprudata->trjfname, "a");
+      SCIP_CALL( SCIPreadPolicyCalibration(scip, nodeprudata->calibfname, nodeprudata->policy) );
+      SCIP_CALL( SCIPpolicyCheckThreshold(scip, nodeprudata->policy, nodeprudata->threshold,
+            nodeprudata->thresholdslope, NODEPRU_NAME) );
    }
 
    /* create feat */
    nodeprudata->feat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeprudata->feat, SCIP_FEATNODEPRU_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeprudata->feat, SCIP_FEATNODEPRU_SIZE, &nodeprudata->featopts) );
    assert(nodeprudata->feat != NULL);
    SCIPfeatSetMaxDepth(nodeprudata->feat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
 
+   /* the normalization of the policy must match the features of a node, including the optional ones */
+   SCIP_CALL( SCIPpolicyCheckFeatSize(scip, nodeprudata->policy, SCIPfeatGetSize(nodeprudata->feat), nodeprudata->polfname) );
+
+   /* open trajectory file for writing */
+   /* open in appending mode for writing training file from multiple problems */
+   nodeprudata->trj = NULL;
+   if( nodeprudata->trjfname != NULL && nodeprudata->trjfname[0] != '\0' )
+   {
+      SCIP_CALL( SCIPtrjCreate(scip, &nodeprudata->trj, nodeprudata->trjfname, SCIPfeatGetSize(nodeprudata->feat), 0,
+            nodeprudata->weightscheme, nodeprudata->dedupquant) );
+   }
+
    if( strcmp(SCIPnodeselGetName(SCIPgetNodesel(scip)), "oracle") == 0 ||
        strcmp(SCIPnodeselGetName(SCIPgetNodesel(scip)), "dagger") == 0 )
       nodeprudata->checkopt = FALSE;
@@ -139,6 +187,16 @@ SCIP_DECL_NODEPRUINIT(nodepruInitDagger)
    nodeprudata->nnodes = 0;
    nodeprudata->nfalsepos = 0;
    nodeprudata->nfalseneg = 0;
+   nodeprudata->nevicted = 0;
+   nodeprudata->nevictedopt = 0;
+   nodeprudata->memleaves = 0;
+   nodeprudata->memevicted = 0.0;
+
+   nodeprudata->coldstore = NULL;
+   if( nodeprudata->softprune )
+   {
+      SCIP_CALL( SCIPcoldstoreCreate(scip, &nodeprudata->coldstore, nodeprudata->coldnodes) );
+   }
    nodeprudata->randseed = 0;
 
    return SCIP_OKAY;
@@ -157,10 +215,9 @@ SCIP_DECL_NODEPRUEXIT(nodepruExitDagger)
    assert(nodeprudata->optsol != NULL);
    SCIP_CALL( SCIPfreeSolSelf(scip, &nodeprudata->optsol) );
 
-   if( nodeprudata->trjfile != NULL)
+   if( nodeprudata->trj != NULL )
    {
-      fclose(nodeprudata->wfile);
-      fclose(nodeprudata->trjfile);
+      SCIP_CALL( SCIPtrjFree(scip, &nodeprudata->trj) );
    }
 
    assert(nodeprudata->feat != NULL);
@@ -169,6 +226,11 @@ SCIP_DECL_NODEPRUEXIT(nodepruExitDagger)
    assert(nodeprudata->policy != NULL);
    SCIP_CALL( SCIPpolicyFree(scip, &nodeprudata->policy) );
 
+   if( nodeprudata->coldstore != NULL )
+   {
+      SCIP_CALL( SCIPcoldstoreFree(scip, &nodeprudata->coldstore) );
+   }
+
    return SCIP_OKAY;
 }
 
@@ -226,7 +288,8 @@ SCIP_DECL_NODEPRUPRUNE(nodepruPruneDagger)
          *prune = (isoptimal == FALSE);
       else
       { */
-         if( SCIPsetIsGT(scip->set, SCIPnodeGetScore(node), 0) )
+         if( SCIPpolicyPruneNode(scip, node, nodeprudata->policy, nodeprudata->threshold, nodeprudata->thresholdslope,
+               nodeprudata->safegap) )
          {
             /* don't prune optimal */
             /*
@@ -237,6 +300,16 @@ SCIP_DECL_NODEPRUPRUNE(nodepruPruneDagger)
                *prune = TRUE;
                SCIPdebugMessage("pruning node: #%"SCIP_LONGINT_FORMAT"\n", SCIPnodeGetNumber(node));
                nodeprudata->nprunes++;
+
+               /* park the node; if it was the last one, revisit the parked nodes now */
+               if( nodeprudata->coldstore != NULL )
+               {
+                  SCIP_CALL( SCIPcoldstoreAdd(scip, nodeprudata->coldstore, node, SCIPnodeGetScore(node)) );
+                  if( SCIPgetNNodesLeft(scip) == 0 )
+                  {
+                     SCIP_CALL( SCIPcoldstoreRevisit(scip, nodeprudata->coldstore) );
+                  }
+               }
             /*
             } */
          }
@@ -250,17 +323,26 @@ SCIP_DECL_NODEPRUPRUNE(nodepruPruneDagger)
       else if( (!isoptimal) && (!*prune) )
          nodeprudata->nfalseneg++;
 
-/* write feature vector to stdout in debug mode */
-#ifndef SCIP_DEBUG
       /* write examples */
-      if( nodeprudata->trjfile != NULL )
+      if( nodeprudata->trj != NULL )
       {
-#endif
          SCIPdebugMessage("node pruning feature of node #%"SCIP_LONGINT_FORMAT"\n", SCIPnodeGetNumber(node));
-         SCIPfeatLIBSVMPrint(scip, nodeprudata->trjfile, nodeprudata->wfile, nodeprudata->feat, isoptimal ? -1 : 1);
-#ifndef SCIP_DEBUG
+         SCIP_CALL( SCIPtrjAddFeat(scip, nodeprudata->trj, nodeprudata->feat, node, isoptimal ? -1 : 1, 1.0) );
       }
-#endif
+   }
+
+   /* the node is processed: count it in the subtrees of its ancestors */
+   if( nodeprudata->trj != NULL && !*prune )
+   {
+      SCIP_CALL( SCIPtrjCountFocus(scip, nodeprudata->trj, node) );
+   }
+
+   /* keep the open leaves within the budget */
+   if( nodeprudata->maxleaves > 0 || nodeprudata->memlimit > 0.0 )
+   {
+      SCIP_CALL( SCIPevictLeavesOverBudget(scip, nodeprudata->feat, nodeprudata->policy, nodeprudata->maxleaves,
+            nodeprudata->memlimit, nodeprudata->evictfrac, nodeprudata->optsol, nodeprudata->coldstore,
+            &nodeprudata->memleaves, &nodeprudata->memevicted, &nodeprudata->nevicted, &nodeprudata->nevictedopt) );
    }
 
    return SCIP_OKAY;
@@ -287,6 +369,8 @@ SCIP_RETCODE SCIPincludeNodepruDagger(
    nodeprudata->solfname = NULL;
    nodeprudata->trjfname = NULL;
    nodeprudata->polfname = NULL;
+   nodeprudata->calibfname = NULL;
+   nodeprudata->coldstore = NULL;
 
    /* use SCIPincludeNodepruBasic() plus setter functions if you want to set callbacks one-by-one and your code should
     * compile independent of new callbacks being added in future SCIP versions
@@ -302,6 +386,8 @@ SCIP_RETCODE SCIPincludeNodepruDagger(
    SCIP_CALL( SCIPsetNodepruExit(scip, nodepru, nodepruExitDagger) );
    SCIP_CALL( SCIPsetNodepruFree(scip, nodepru, nodepruFreeDagger) );
 
+   SCIP_CALL( SCIPincludeEventhdlrColdstore(scip, "coldstore_"NODEPRU_NAME, &nodeprudata->coldstore) );
+
    /* add dagger node pruner parameters */
    SCIP_CALL( SCIPaddStringParam(scip,
          "nodepruning/"NODEPRU_NAME"/solfname",
@@ -311,10 +397,55 @@ SCIP_RETCODE SCIPincludeNodepruDagger(
          "nodepruning/"NODEPRU_NAME"/trjfname",
          "name of the file to write node pruning trajectories",
          &nodeprudata->trjfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddCharParam(scip,
+         "nodepruning/"NODEPRU_NAME"/weightscheme",
+         "weighting scheme of examples, normalized to mean one per instance ('d'epth decay, 'u'niform, inverse 'f'requency of depth and bound type, 's'ubtree size)",
+         &nodeprudata->weightscheme, FALSE, DEFAULT_WEIGHTSCHEME, SCIP_TRJ_WEIGHTSCHEMES, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/dedupquant",
+         "quantization step of features for merging duplicate examples with summed weight (0: no merging)",
+         &nodeprudata->dedupquant, FALSE, DEFAULT_DEDUPQUANT, 0.0, SCIP_REAL_MAX, NULL, NULL) );
    SCIP_CALL( SCIPaddStringParam(scip,
          "nodepruning/"NODEPRU_NAME"/polfname",
          "name of the policy model file",
          &nodeprudata->polfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodepruning/"NODEPRU_NAME"/maxleaves",
+         "maximum number of open leaves, leaves with the largest pruning scores are evicted beyond it (0: no limit)",
+         &nodeprudata->maxleaves, FALSE, DEFAULT_MAXLEAVES, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/memlimit",
+         "maximum memory used in MB; when it is exceeded, the fraction evictfrac of the leaves with the largest pruning scores is evicted and the number of leaves left is kept as a budget until the memory used grows by another 10% (0: no limit)",
+         &nodeprudata->memlimit, FALSE, DEFAULT_MEMLIMIT, 0.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/evictfrac",
+         "fraction of the open leaves evicted at least when the budget of leaves or memory is exceeded",
+         &nodeprudata->evictfrac, FALSE, DEFAULT_EVICTFRAC, 0.0, 1.0, NULL, NULL) );
+   SCIP_CALL( SCIPaddBoolParam(scip,
+         "nodepruning/"NODEPRU_NAME"/softprune",
+         "park pruned nodes in a cold store, which is revisited by sub-SCIPs when the tree is empty?",
+         &nodeprudata->softprune, FALSE, DEFAULT_SOFTPRUNE, NULL, NULL) );
+   SCIP_CALL( SCIPaddLongintParam(scip,
+         "nodepruning/"NODEPRU_NAME"/coldnodes",
+         "node limit of the sub-SCIP revisiting a parked node",
+         &nodeprudata->coldnodes, FALSE, DEFAULT_COLDNODES, -1LL, SCIP_LONGINT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddStringParam(scip,
+         "nodepruning/"NODEPRU_NAME"/calibfname",
+         "name of the file calibrating policy scores to pruning probabilities (Platt or isotonic); the threshold then has to be within (0,1) at all depths",
+         &nodeprudata->calibfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/threshold",
+         "nodes are pruned if their (calibrated) policy score exceeds the threshold; a probability within (0,1), e.g., 0.5, with a calibration",
+         &nodeprudata->threshold, FALSE, DEFAULT_THRESHOLD, -SCIP_REAL_MAX, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/thresholdslope",
+         "change of the threshold from the root to the maximum depth, i.e., the number of integer variables",
+         &nodeprudata->thresholdslope, FALSE, DEFAULT_THRESHOLDSLOPE, -SCIP_REAL_MAX, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/safegap",
+         "nodes whose lower bound is within this relative gap of the incumbent are never pruned (negative: off)",
+         &nodeprudata->safegap, FALSE, DEFAULT_SAFEGAP, -1.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPfeatAddOptsParams(scip, "nodepruning/"NODEPRU_NAME, &nodeprudata->featopts) );
 
    return SCIP_OKAY;
 }
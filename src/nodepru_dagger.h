@@ -23,6 +23,7 @@
 
 #include "scip/scip.h"
 #include "feat.h"
+#include "coldstore.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +35,12 @@ SCIP_RETCODE SCIPincludeNodepruDagger(
    SCIP*                 scip                /**< SCIP data structure */
    );
 
+/** returns the store in which the dagger node pruner parks pruned nodes, or NULL if softprune is off */
+EXTERN
+SCIP_COLDSTORE* SCIPnodeprudaggerGetColdstore(
+   SCIP_NODEPRU*         nodepru
+   );
+
 EXTERN
 void SCIPnodeprudaggerPrintStatistics(
    SCIP*                 scip,
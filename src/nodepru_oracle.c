@@ -15,6 +15,7 @@
 #include "scip/sol.h"
 #include "scip/struct_set.h"
 #include "feat.h"
+#include "trj.h"
 
 #define NODEPRU_NAME            "oracle"
 #define NODEPRU_DESC            "node pruner which always prunes non-optimal nodes"
@@ -22,6 +23,8 @@
 #define NODEPRU_MEMSAVEPRIORITY 0
 
 #define DEFAULT_FILENAME        ""
+#define DEFAULT_WEIGHTSCHEME    'd'          /**< weighting scheme of examples (see SCIP_TRJ_WEIGHTSCHEMES) */
+#define DEFAULT_DEDUPQUANT      0.0          /**< quantization step of features for merging duplicate examples (0: off) */
 
 /*
  * Data structures
@@ -35,8 +38,10 @@ struct SCIP_NodepruData
    char*              solfname;           /**< name of the solution file */
    char*              trjfname;           /**< name of the trajectory file */
    SCIP_Bool          checkopt;           /**< need to check node optimality? (don't need to if node selector is oracle or dagger */
-   FILE*              wfile;
-   FILE*              trjfile;
+   SCIP_TRJ*          trj;                /**< trajectory examples are written to */
+   char               weightscheme;       /**< weighting scheme of examples */
+   SCIP_Real          dedupquant;         /**< quantization step of features for merging duplicate examples */
+   SCIP_FEATOPTS      featopts;           /**< optional families of features appended to the node features */
 };
 
 /*
@@ -71,22 +76,19 @@ SCIP_DECL_NODEPRUINIT(nodepruInitOracle)
    else
       nodeprudata->checkopt = TRUE;
 
-   nodeprudata->trjfile = NULL;
-   if( nodeprudata->trjfname != NULL )
-   {
-      char wfname[SCIP_MAXSTRLEN];
-      strcpy(wfname, nodeprudata->trjfname);
-      strcat(wfname, ".weight");
-      nodeprudata->wfile = fopen(wfname, "a");
-      nodeprudata->trjfile = fopen(nodeprudata->trjfname, "a");
-   }
-
    /* create feat */
    nodeprudata->feat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeprudata->feat, SCIP_FEATNODEPRU_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeprudata->feat, SCIP_FEATNODEPRU_SIZE, &nodeprudata->featopts) );
    assert(nodeprudata->feat != NULL);
    SCIPfeatSetMaxDepth(nodeprudata->feat, (SCIP_Real)SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
 
+   nodeprudata->trj = NULL;
+   if( nodeprudata->trjfname != NULL && nodeprudata->trjfname[0] != '\0' )
+   {
+      SCIP_CALL( SCIPtrjCreate(scip, &nodeprudata->trj, nodeprudata->trjfname, SCIPfeatGetSize(nodeprudata->feat), 0,
+            nodeprudata->weightscheme, nodeprudata->dedupquant) );
+   }
+
    return SCIP_OKAY;
 }
 
@@ -110,12 +112,10 @@ SCIP_DECL_NODEPRUEXIT(nodepruExitOracle)
       nodeprudata->feat = NULL;
    }
 
-   if( nodeprudata->trjfile != NULL)
+   if( nodeprudata->trj != NULL )
    {
-      fclose(nodeprudata->wfile);
-      fclose(nodeprudata->trjfile);
-      nodeprudata->trjfile = NULL;
-      nodeprudata->wfile = NULL;
+      SCIP_CALL( SCIPtrjFree(scip, &nodeprudata->trj) );
+      nodeprudata->trj = NULL;
    }
 
    nodeprudata->checkopt = FALSE;
@@ -176,17 +176,19 @@ SCIP_DECL_NODEPRUPRUNE(nodepruPruneOracle)
          *prune = TRUE;
       }
 
-#ifndef SCIP_DEBUG
-      if( nodeprudata->trjfile != NULL )
+      if( nodeprudata->trj != NULL )
       {
-#endif
          SCIPcalcNodepruFeat(scip, node, nodeprudata->feat);
          SCIPdebugMessage("node pruning feature of node #%"SCIP_LONGINT_FORMAT"\n", SCIPnodeGetNumber(node));
-         SCIPfeatLIBSVMPrint(scip, nodeprudata->trjfile, nodeprudata->wfile, nodeprudata->feat, *prune ? 1 : -1);
+         SCIP_CALL( SCIPtrjAddFeat(scip, nodeprudata->trj, nodeprudata->feat, node, *prune ? 1 : -1, 1.0) );
       }
-#ifndef SCIP_DEBUG
    }
-#endif
+
+   /* the node is processed: count it in the subtrees of its ancestors */
+   if( nodeprudata->trj != NULL && !*prune )
+   {
+      SCIP_CALL( SCIPtrjCountFocus(scip, nodeprudata->trj, node) );
+   }
 
    return SCIP_OKAY;
 }
@@ -234,6 +236,15 @@ SCIP_RETCODE SCIPincludeNodepruOracle(
          "nodepruning/"NODEPRU_NAME"/trjfname",
          "name of the file to write node pruning trajectories",
          &nodeprudata->trjfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddCharParam(scip,
+         "nodepruning/"NODEPRU_NAME"/weightscheme",
+         "weighting scheme of examples, normalized to mean one per instance ('d'epth decay, 'u'niform, inverse 'f'requency of depth and bound type, 's'ubtree size)",
+         &nodeprudata->weightscheme, FALSE, DEFAULT_WEIGHTSCHEME, SCIP_TRJ_WEIGHTSCHEMES, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/dedupquant",
+         "quantization step of features for merging duplicate examples with summed weight (0: no merging)",
+         &nodeprudata->dedupquant, FALSE, DEFAULT_DEDUPQUANT, 0.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPfeatAddOptsParams(scip, "nodepruning/"NODEPRU_NAME, &nodeprudata->featopts) );
 
    return SCIP_OKAY;
 }
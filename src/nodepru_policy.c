@@ -15,11 +15,14 @@
 
 /*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
 #include <assert.h>
+#include <math.h>
 #include <string.h>
 #include "nodepru_policy.h"
 #include "nodepru_oracle.h"
 #include "nodesel_oracle.h"
 #include "feat.h"
+#include "opentree.h"
+#include "coldstore.h"
 #include "policy.h"
 #include "struct_policy.h"
 #include "scip/sol.h"
@@ -35,6 +38,18 @@
 #define NODEPRU_MEMSAVEPRIORITY 0
 
 #define DEFAULT_FILENAME        ""
+#define DEFAULT_MAXLEAVES       0            /**< maximum number of open leaves before eviction (0: no limit) */
+#define DEFAULT_MEMLIMIT        0.0          /**< maximum memory used in MB before eviction (0: no limit) */
+#define DEFAULT_EVICTFRAC       0.1          /**< fraction of the leaves evicted when the budget is exceeded */
+#define EVICTMEMGROWTH          0.1          /**< growth of the memory used since the last memory eviction that lowers
+                                              *   the budget of leaves again */
+#define DEFAULT_THRESHOLD       0.0          /**< nodes are pruned if their (calibrated) policy score exceeds it */
+#define DEFAULT_THRESHOLDSLOPE  0.0          /**< change of the threshold from the root to the maximum depth */
+#define DEFAULT_SAFEGAP         -1.0         /**< nodes within this relative gap of the incumbent are kept (<0: off) */
+#define DEFAULT_SOFTPRUNE       FALSE        /**< park pruned nodes in a cold store instead of deleting them? */
+#define DEFAULT_COLDNODES       1000         /**< node limit of the sub-SCIP revisiting a parked node */
+#define DEFAULT_ADAPTRATE       0.0          /**< step size of the online threshold controller (0: off) */
+#define DEFAULT_ADAPTRANGE      1.0          /**< maximum absolute offset of the threshold set by the controller */
 
 /*
  * Data structures
@@ -47,8 +62,205 @@ struct SCIP_NodepruData
    SCIP_POLICY*       policy;
    SCIP_FEAT*         feat;
    int                nprunes;
+   int                maxleaves;          /**< maximum number of open leaves before eviction (0: no limit) */
+   SCIP_Real          memlimit;           /**< maximum memory used in MB before eviction (0: no limit) */
+   SCIP_Real          evictfrac;          /**< fraction of the leaves evicted when the budget is exceeded */
+   int                nevicted;           /**< number of leaves evicted */
+   int                memleaves;          /**< budget of leaves set when the memory limit was exceeded, or 0 */
+   SCIP_Real          memevicted;         /**< memory used when the budget of leaves was set, or 0 */
+   char*              calibfname;         /**< name of the calibration file */
+   SCIP_Real          threshold;          /**< nodes are pruned if their (calibrated) policy score exceeds it */
+   SCIP_Real          thresholdslope;     /**< change of the threshold from the root to the maximum depth */
+   SCIP_Real          safegap;            /**< nodes within this relative gap of the incumbent are kept (<0: off) */
+   SCIP_Bool          softprune;          /**< park pruned nodes in a cold store instead of deleting them? */
+   SCIP_Longint       coldnodes;          /**< node limit of the sub-SCIP revisiting a parked node */
+   SCIP_COLDSTORE*    coldstore;          /**< store of parked nodes, or NULL */
+   SCIP_Real          adaptrate;          /**< step size of the online threshold controller (0: off) */
+   SCIP_Real          adaptrange;         /**< maximum absolute offset of the threshold set by the controller */
+   SCIP_Real          offset;             /**< offset of the threshold set by the controller */
+   SCIP_Real          firstgap;           /**< gap when the first solution was known, or infinity */
+   SCIP_FEATOPTS      featopts;           /**< optional families of features appended to the node features */
 };
 
+SCIP_Bool SCIPpolicyPruneNode(
+   SCIP*                 scip,
+   SCIP_NODE*            node,
+   SCIP_POLICY*          policy,
+   SCIP_Real             threshold,
+   SCIP_Real             thresholdslope,
+   SCIP_Real             safegap
+   )
+{
+   int maxdepth;
+
+   assert(scip != NULL);
+   assert(node != NULL);
+
+   maxdepth = SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip);
+   if( maxdepth > 0 )
+      threshold += thresholdslope * MIN(SCIPnodeGetDepth(node), maxdepth) / maxdepth;
+
+   if( !SCIPsetIsGT(scip->set, SCIPpolicyCalibrate(policy, SCIPnodeGetScore(node)), threshold) )
+      return FALSE;
+
+   if( safegap >= 0.0 && SCIPgetNSols(scip) > 0
+      && SCIPrelDiff(SCIPgetUpperbound(scip), SCIPnodeGetLowerbound(node)) <= safegap )
+   {
+      SCIPdebugMessage("keeping node #%"SCIP_LONGINT_FORMAT" within the safe gap\n", SCIPnodeGetNumber(node));
+      return FALSE;
+   }
+
+   return TRUE;
+}
+
+SCIP_RETCODE SCIPpolicyCheckThreshold(
+   SCIP*                 scip,
+   SCIP_POLICY*          policy,
+   SCIP_Real             threshold,
+   SCIP_Real             thresholdslope,
+   const char*           name
+   )
+{
+   assert(scip != NULL);
+   assert(policy != NULL);
+
+   if( policy->calibtype == 'n' )
+      return SCIP_OKAY;
+
+   if( threshold <= 0.0 || threshold >= 1.0 || threshold + thresholdslope <= 0.0 || threshold + thresholdslope >= 1.0 )
+   {
+      SCIPerrorMessage("calibrated scores are probabilities, but the threshold of node pruner <%s> is %g at the root "
+         "and %g at the maximum depth; set nodepruning/%s/threshold (and thresholdslope) within (0,1), e.g., to 0.5\n",
+         name, threshold, threshold + thresholdslope, name);
+      return SCIP_PARAMETERWRONGVAL;
+   }
+
+   return SCIP_OKAY;
+}
+
+SCIP_RETCODE SCIPevictLeavesOverBudget(
+   SCIP*                 scip,
+   SCIP_FEAT*            feat,
+   SCIP_POLICY*          policy,
+   int                   maxleaves,
+   SCIP_Real             memlimit,
+   SCIP_Real             evictfrac,
+   SCIP_SOL*             optsol,
+   SCIP_COLDSTORE*       coldstore,
+   int*                  memleaves,
+   SCIP_Real*            memevicted,
+   int*                  nevicted,
+   int*                  nevictedopt
+   )
+{
+   SCIP_NODE** leaves;
+   SCIP_NODE** evict;
+   SCIP_Real* prunescores;
+   SCIP_Real* featvals;
+   int* offsets;
+   SCIP_Real memused;
+   int size;
+   int nleaves;
+   int budget;
+   int nevict;
+   int i;
+
+   assert(scip != NULL);
+   assert(memleaves != NULL);
+   assert(memevicted != NULL);
+   assert(nevicted != NULL);
+   assert(nevictedopt != NULL);
+
+   nleaves = SCIPgetNLeaves(scip);
+   if( nleaves == 0 )
+      return SCIP_OKAY;
+
+   /* block memory is not returned when leaves are freed, so the memory used does not drop after an eviction; a
+    * crossing of the memory limit rather sets a budget of leaves, and only a further growth of the memory used
+    * lowers it again
+    */
+   if( memlimit > 0.0 )
+   {
+      memused = (SCIP_Real)SCIPgetMemUsed(scip);
+      if( memused > memlimit * 1048576.0 && (*memevicted == 0.0 || memused > (1.0 + EVICTMEMGROWTH) * *memevicted) )
+      {
+         *memleaves = MAX(nleaves - (int)SCIPceil(scip, evictfrac * nleaves), 1);
+         *memevicted = memused;
+         SCIPdebugMessage("memory used %.1f MB exceeds the limit, budget of %d leaves\n", memused / 1048576.0,
+            *memleaves);
+      }
+   }
+
+   budget = maxleaves;
+   if( *memleaves > 0 && (budget == 0 || *memleaves < budget) )
+      budget = *memleaves;
+   if( budget == 0 || nleaves <= budget )
+      return SCIP_OKAY;
+
+   /* evict at least the fraction evictfrac, so that the leaves are not scored again for each new leaf */
+   nevict = MAX(nleaves - budget, (int)SCIPceil(scip, evictfrac * nleaves));
+   nevict = MIN(nevict, nleaves);
+
+   SCIP_CALL( SCIPgetLeaves(scip, &leaves, &nleaves) );
+
+   /* score a copy of the leaves, since the queue is rebuilt by the eviction */
+   SCIP_CALL( SCIPduplicateBufferArray(scip, &evict, leaves, nleaves) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &prunescores, nleaves) );
+
+   /* collect the examples of all leaves and score them at once; the score of a leaf belongs to the node selector */
+   size = SCIPfeatGetSize(feat);
+   SCIP_CALL( SCIPallocBufferArray(scip, &featvals, nleaves * size) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &offsets, nleaves) );
+   for( i = 0; i < nleaves; i++ )
+   {
+      SCIPcalcNodepruFeat(scip, evict[i], feat);
+      BMScopyMemoryArray(&featvals[i * size], SCIPfeatGetVals(feat), size);
+      offsets[i] = SCIPfeatGetOffset(feat);
+   }
+   SCIPpolicyScoreBatch(policy, featvals, offsets, size, nleaves, prunescores);
+   SCIPfreeBufferArray(scip, &offsets);
+   SCIPfreeBufferArray(scip, &featvals);
+
+   SCIPsortDownRealPtr(prunescores, (void**)evict, nleaves);
+
+   SCIPdebugMessage("evicting %d of %d leaves\n", nevict, nleaves);
+
+   for( i = 0; i < nevict; i++ )
+   {
+      if( optsol != NULL )
+      {
+         if( !SCIPnodeIsOptchecked(evict[i]) )
+         {
+            SCIP_CALL( SCIPnodeCheckOptimal(scip, evict[i], optsol) );
+            SCIPnodeSetOptchecked(evict[i]);
+         }
+         if( SCIPnodeIsOptimal(evict[i]) )
+            (*nevictedopt)++;
+      }
+      if( coldstore != NULL )
+      {
+         SCIP_CALL( SCIPcoldstoreAdd(scip, coldstore, evict[i], SCIPnodeGetScore(evict[i])) );
+      }
+   }
+   SCIP_CALL( SCIPevictLeaves(scip, evict, nevict) );
+   *nevicted += nevict;
+
+   SCIPfreeBufferArray(scip, &prunescores);
+   SCIPfreeBufferArray(scip, &evict);
+
+   return SCIP_OKAY;
+}
+
+SCIP_COLDSTORE* SCIPnodeprupolicyGetColdstore(
+   SCIP_NODEPRU*         nodepru
+   )
+{
+   assert(nodepru != NULL);
+   assert(strcmp(SCIPnodepruGetName(nodepru), NODEPRU_NAME) == 0);
+
+   return SCIPnodepruGetData(nodepru)->coldstore;
+}
+
 void SCIPnodeprupolicyPrintStatistics(
    SCIP*                 scip,
    SCIP_NODEPRU*         nodepru,
@@ -67,10 +279,80 @@ void SCIPnodeprupolicyPrintStatistics(
          "Node pruner        :\n");
    SCIPmessageFPrintInfo(scip->messagehdlr, file, 
          "  nodes pruned     : %10d\n", nodeprudata->nprunes);
+   SCIPmessageFPrintInfo(scip->messagehdlr, file, 
+         "  leaves evicted   : %10d\n", nodeprudata->nevicted);
+   if( nodeprudata->coldstore != NULL )
+      SCIPcoldstorePrintStatistics(scip, nodeprudata->coldstore, file);
+   if( nodeprudata->adaptrate > 0.0 )
+      SCIPmessageFPrintInfo(scip->messagehdlr, file, 
+         "  threshold offset : %10.4f\n", nodeprudata->offset);
    SCIPmessageFPrintInfo(scip->messagehdlr, file, 
          "  pruning time     : %10.2f\n", SCIPnodepruGetTime(nodepru));
 }
 
+/** move the threshold offset such that the open nodes fit into the remaining node or time budget
+ *
+ *  The pressure is the log ratio of open nodes to the nodes that can still be processed at the observed throughput,
+ *  plus the lag of the gap closure behind the used fraction of the budget. A positive pressure lowers the threshold,
+ *  i.e., more nodes are pruned, a negative one raises it.
+ */
+static
+SCIP_RETCODE adaptThreshold(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_NODEPRUDATA*     nodeprudata         /**< node pruner data */
+   )
+{
+   SCIP_Real timelimit;
+   SCIP_Longint nodelimit;
+   SCIP_Real used;
+   SCIP_Real capacity;
+   SCIP_Real closure;
+   SCIP_Real gap;
+   SCIP_Real pressure;
+   SCIP_Longint nnodes;
+
+   SCIP_CALL( SCIPgetRealParam(scip, "limits/time", &timelimit) );
+   SCIP_CALL( SCIPgetLongintParam(scip, "limits/nodes", &nodelimit) );
+   nnodes = SCIPgetNNodes(scip);
+
+   /* fraction of the budget used and number of nodes that can still be processed */
+   used = 0.0;
+   capacity = SCIPinfinity(scip);
+   if( nodelimit >= 0 )
+   {
+      used = (SCIP_Real)nnodes / MAX(nodelimit, 1);
+      capacity = (SCIP_Real)(nodelimit - nnodes);
+   }
+   if( !SCIPisInfinity(scip, timelimit) && SCIPgetSolvingTime(scip) > 0.0 )
+   {
+      SCIP_Real time = SCIPgetSolvingTime(scip);
+
+      used = MAX(used, time / timelimit);
+      capacity = MIN(capacity, nnodes / time * (timelimit - time));
+   }
+
+   /* no budget to spend */
+   if( SCIPisInfinity(scip, capacity) )
+      return SCIP_OKAY;
+   capacity = MAX(capacity, 0.0);
+   used = MIN(used, 1.0);
+
+   /* fraction of the gap at the first solution that has been closed; without a solution, take it as on schedule */
+   gap = SCIPgetGap(scip);
+   if( SCIPisInfinity(scip, nodeprudata->firstgap) && !SCIPisInfinity(scip, gap) )
+      nodeprudata->firstgap = gap;
+   if( !SCIPisInfinity(scip, gap) && SCIPisPositive(scip, nodeprudata->firstgap) )
+      closure = 1.0 - gap / nodeprudata->firstgap;
+   else
+      closure = used;
+
+   pressure = log((SCIPgetNNodesLeft(scip) + 1.0) / (capacity + 1.0)) + (used - closure);
+   nodeprudata->offset -= nodeprudata->adaptrate * pressure;
+   nodeprudata->offset = MAX(-nodeprudata->adaptrange, MIN(nodeprudata->offset, nodeprudata->adaptrange));
+
+   return SCIP_OKAY;
+}
+
 /** solving process initialization method of node pruner (called when branch and bound process is about to begin) */
 static
 SCIP_DECL_NODEPRUINIT(nodepruInitPolicy)
@@ -85,16 +367,34 @@ SCIP_DECL_NODEPRUINIT(nodepruInitPolicy)
    /* read policy */
    SCIP_CALL( SCIPpolicyCreate(scip, &nodeprudata->policy) );
    assert(nodeprudata->polfname != NULL);
-   SCIP_CALL( SCIPreadLIBSVMPolicy(scip, nodeprudata->polfname, &nodeprudata->policy) );
-   assert(nodeprudata->policy->weights != NULL);
+   SCIP_CALL( SCIPreadPolicy(scip, nodeprudata->polfname, &nodeprudata->policy) );
+   if( nodeprudata->calibfname != NULL && nodeprudata->calibfname[0] != '\0' )
+   {
+      SCIP_CALL( SCIPreadPolicyCalibration(scip, nodeprudata->calibfname, nodeprudata->policy) );
+      SCIP_CALL( SCIPpolicyCheckThreshold(scip, nodeprudata->policy, nodeprudata->threshold,
+            nodeprudata->thresholdslope, NODEPRU_NAME) );
+   }
   
    /* create feat */
    nodeprudata->feat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeprudata->feat, SCIP_FEATNODEPRU_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeprudata->feat, SCIP_FEATNODEPRU_SIZE, &nodeprudata->featopts) );
    assert(nodeprudata->feat != NULL);
    SCIPfeatSetMaxDepth(nodeprudata->feat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
 
+   /* the normalization of the policy must match the features of a node, including the optional ones */
+   SCIP_CALL( SCIPpolicyCheckFeatSize(scip, nodeprudata->policy, SCIPfeatGetSize(nodeprudata->feat), nodeprudata->polfname) );
+
    nodeprudata->nprunes = 0;
+   nodeprudata->nevicted = 0;
+   nodeprudata->memleaves = 0;
+   nodeprudata->memevicted = 0.0;
+   nodeprudata->offset = 0.0;
+   nodeprudata->coldstore = NULL;
+   if( nodeprudata->softprune )
+   {
+      SCIP_CALL( SCIPcoldstoreCreate(scip, &nodeprudata->coldstore, nodeprudata->coldnodes) );
+   }
+   nodeprudata->firstgap = SCIPinfinity(scip);
  
    return SCIP_OKAY;
 }
@@ -114,6 +414,11 @@ SCIP_DECL_NODEPRUEXIT(nodepruExitPolicy)
 
    assert(nodeprudata->policy != NULL);
    SCIP_CALL( SCIPpolicyFree(scip, &nodeprudata->policy) );
+
+   if( nodeprudata->coldstore != NULL )
+   {
+      SCIP_CALL( SCIPcoldstoreFree(scip, &nodeprudata->coldstore) );
+   }
   
    return SCIP_OKAY;
 }
@@ -163,16 +468,42 @@ SCIP_DECL_NODEPRUPRUNE(nodepruPrunePolicy)
       */
       SCIPcalcNodeScore(node, nodeprudata->feat, nodeprudata->policy);
 
-      if( SCIPsetIsGT(scip->set, SCIPnodeGetScore(node), 0) )
+      if( nodeprudata->adaptrate > 0.0 )
+      {
+         SCIP_CALL( adaptThreshold(scip, nodeprudata) );
+      }
+
+      if( SCIPpolicyPruneNode(scip, node, nodeprudata->policy, nodeprudata->threshold + nodeprudata->offset,
+            nodeprudata->thresholdslope, nodeprudata->safegap) )
       {
          *prune = TRUE;
          nodeprudata->nprunes++;
+
+         /* park the node; if it was the last one, revisit the parked nodes now */
+         if( nodeprudata->coldstore != NULL )
+         {
+            SCIP_CALL( SCIPcoldstoreAdd(scip, nodeprudata->coldstore, node, SCIPnodeGetScore(node)) );
+            if( SCIPgetNNodesLeft(scip) == 0 )
+            {
+               SCIP_CALL( SCIPcoldstoreRevisit(scip, nodeprudata->coldstore) );
+            }
+         }
          SCIPdebugMessage("pruning node: #%"SCIP_LONGINT_FORMAT"\n", SCIPnodeGetNumber(node));
       }
       else
          *prune = FALSE;
    }
 
+   /* keep the open leaves within the budget */
+   if( nodeprudata->maxleaves > 0 || nodeprudata->memlimit > 0.0 )
+   {
+      int nevictedopt = 0;
+
+      SCIP_CALL( SCIPevictLeavesOverBudget(scip, nodeprudata->feat, nodeprudata->policy, nodeprudata->maxleaves,
+            nodeprudata->memlimit, nodeprudata->evictfrac, NULL, nodeprudata->coldstore, &nodeprudata->memleaves,
+            &nodeprudata->memevicted, &nodeprudata->nevicted, &nevictedopt) );
+   }
+
    return SCIP_OKAY;
 }
 
@@ -194,6 +525,8 @@ SCIP_RETCODE SCIPincludeNodepruPolicy(
 
    nodepru = NULL;
    nodeprudata->polfname = NULL;
+   nodeprudata->calibfname = NULL;
+   nodeprudata->coldstore = NULL;
 
    /* use SCIPincludeNodepruBasic() plus setter functions if you want to set callbacks one-by-one and your code should
     * compile independent of new callbacks being added in future SCIP versions
@@ -209,11 +542,58 @@ SCIP_RETCODE SCIPincludeNodepruPolicy(
    SCIP_CALL( SCIPsetNodepruExit(scip, nodepru, nodepruExitPolicy) );
    SCIP_CALL( SCIPsetNodepruFree(scip, nodepru, nodepruFreePolicy) );
 
+   SCIP_CALL( SCIPincludeEventhdlrColdstore(scip, "coldstore_"NODEPRU_NAME, &nodeprudata->coldstore) );
+
    /* add policy node pruner parameters */
    SCIP_CALL( SCIPaddStringParam(scip, 
          "nodepruning/"NODEPRU_NAME"/polfname",
          "name of the policy model file",
          &nodeprudata->polfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodepruning/"NODEPRU_NAME"/maxleaves",
+         "maximum number of open leaves, leaves with the largest pruning scores are evicted beyond it (0: no limit)",
+         &nodeprudata->maxleaves, FALSE, DEFAULT_MAXLEAVES, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/memlimit",
+         "maximum memory used in MB; when it is exceeded, the fraction evictfrac of the leaves with the largest pruning scores is evicted and the number of leaves left is kept as a budget until the memory used grows by another 10% (0: no limit)",
+         &nodeprudata->memlimit, FALSE, DEFAULT_MEMLIMIT, 0.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/evictfrac",
+         "fraction of the open leaves evicted at least when the budget of leaves or memory is exceeded",
+         &nodeprudata->evictfrac, FALSE, DEFAULT_EVICTFRAC, 0.0, 1.0, NULL, NULL) );
+   SCIP_CALL( SCIPaddStringParam(scip,
+         "nodepruning/"NODEPRU_NAME"/calibfname",
+         "name of the file calibrating policy scores to pruning probabilities (Platt or isotonic); the threshold then has to be within (0,1) at all depths",
+         &nodeprudata->calibfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/threshold",
+         "nodes are pruned if their (calibrated) policy score exceeds the threshold; a probability within (0,1), e.g., 0.5, with a calibration",
+         &nodeprudata->threshold, FALSE, DEFAULT_THRESHOLD, -SCIP_REAL_MAX, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/thresholdslope",
+         "change of the threshold from the root to the maximum depth, i.e., the number of integer variables",
+         &nodeprudata->thresholdslope, FALSE, DEFAULT_THRESHOLDSLOPE, -SCIP_REAL_MAX, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/safegap",
+         "nodes whose lower bound is within this relative gap of the incumbent are never pruned (negative: off)",
+         &nodeprudata->safegap, FALSE, DEFAULT_SAFEGAP, -1.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddBoolParam(scip,
+         "nodepruning/"NODEPRU_NAME"/softprune",
+         "park pruned nodes in a cold store, which is revisited by sub-SCIPs when the tree is empty?",
+         &nodeprudata->softprune, FALSE, DEFAULT_SOFTPRUNE, NULL, NULL) );
+   SCIP_CALL( SCIPaddLongintParam(scip,
+         "nodepruning/"NODEPRU_NAME"/coldnodes",
+         "node limit of the sub-SCIP revisiting a parked node",
+         &nodeprudata->coldnodes, FALSE, DEFAULT_COLDNODES, -1LL, SCIP_LONGINT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/adaptrate",
+         "step size of the controller moving the threshold to spend the node or time limit evenly (0: off)",
+         &nodeprudata->adaptrate, FALSE, DEFAULT_ADAPTRATE, 0.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodepruning/"NODEPRU_NAME"/adaptrange",
+         "maximum absolute offset of the threshold set by the controller",
+         &nodeprudata->adaptrange, FALSE, DEFAULT_ADAPTRANGE, 0.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPfeatAddOptsParams(scip, "nodepruning/"NODEPRU_NAME, &nodeprudata->featopts) );
 
    return SCIP_OKAY;
 }
@@ -23,6 +23,8 @@
 
 #include "scip/scip.h"
 #include "feat.h"
+#include "policy.h"
+#include "coldstore.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +36,63 @@ SCIP_RETCODE SCIPincludeNodepruPolicy(
    SCIP*                 scip                /**< SCIP data structure */
    );
 
+/** if the open leaves exceed their budget, evict the fraction evictfrac of the leaves with the largest pruning scores,
+ *  but at least as many as needed to meet the budget; if optsol is not NULL, the evicted leaves are checked for
+ *  optimality, and if coldstore is not NULL, they are parked in it before they are freed
+ *
+ *  The budget is maxleaves or, if smaller, the budget memleaves set when the memory used exceeded memlimit (MB): the
+ *  number of leaves then minus the fraction evictfrac. Since freed block memory is not returned, the memory used does
+ *  not drop after evictions; memleaves is therefore only lowered again once the memory used has grown by 10% beyond
+ *  memevicted, the memory used when it was set.
+ */
+EXTERN
+SCIP_RETCODE SCIPevictLeavesOverBudget(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_FEAT*            feat,               /**< node pruning features */
+   SCIP_POLICY*          policy,             /**< node pruning policy */
+   int                   maxleaves,          /**< maximum number of open leaves (0: no limit) */
+   SCIP_Real             memlimit,           /**< maximum memory used in MB (0: no limit) */
+   SCIP_Real             evictfrac,          /**< fraction of the leaves evicted when the budget is exceeded */
+   SCIP_SOL*             optsol,             /**< optimal solution, or NULL */
+   SCIP_COLDSTORE*       coldstore,          /**< store in which the evicted leaves are parked, or NULL */
+   int*                  memleaves,          /**< budget of leaves set by the memory limit, or 0; updated */
+   SCIP_Real*            memevicted,         /**< memory used when memleaves was set, or 0; updated */
+   int*                  nevicted,           /**< pointer to increase by the number of evicted leaves */
+   int*                  nevictedopt         /**< pointer to increase by the number of evicted optimal leaves */
+   );
+
+/** check that the threshold of a calibrated policy is a probability within (0,1) at the root and at the maximum depth;
+ *  returns SCIP_PARAMETERWRONGVAL otherwise, since any calibrated score exceeds a threshold of at most 0
+ */
+EXTERN
+SCIP_RETCODE SCIPpolicyCheckThreshold(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_POLICY*          policy,             /**< node pruning policy, possibly calibrated */
+   SCIP_Real             threshold,          /**< threshold at the root */
+   SCIP_Real             thresholdslope,     /**< change of the threshold between the root and the maximum depth */
+   const char*           name                /**< name of the node pruner */
+   );
+
+/** decide whether to prune a node whose policy score is stored as its score: the calibrated score has to exceed the
+ *  threshold, which changes linearly with depth by thresholdslope between the root and the number of integer
+ *  variables; if safegap >= 0, nodes whose lower bound is within the relative gap safegap of the incumbent are kept
+ */
+EXTERN
+SCIP_Bool SCIPpolicyPruneNode(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_NODE*            node,               /**< node to decide on */
+   SCIP_POLICY*          policy,             /**< node pruning policy */
+   SCIP_Real             threshold,          /**< threshold at the root */
+   SCIP_Real             thresholdslope,     /**< change of the threshold between the root and the maximum depth */
+   SCIP_Real             safegap             /**< relative gap to the incumbent within which nodes are kept, or < 0 */
+   );
+
+/** returns the store in which the policy node pruner parks pruned nodes, or NULL if softprune is off */
+EXTERN
+SCIP_COLDSTORE* SCIPnodeprupolicyGetColdstore(
+   SCIP_NODEPRU*         nodepru
+   );
+
 EXTERN
 void SCIPnodeprupolicyPrintStatistics(
    SCIP*                 scip,
@@ -19,6 +19,7 @@
 #include "nodesel_dagger.h"
 #include "nodesel_oracle.h"
 #include "feat.h"
+#include "trj.h"
 #include "policy.h"
 #include "struct_policy.h"
 #include "scip/sol.h"
@@ -32,6 +33,9 @@
 #define NODESEL_MEMSAVEPRIORITY 0
 
 #define DEFAULT_FILENAME        ""
+#define DEFAULT_WEIGHTSCHEME    'd'          /**< weighting scheme of examples (see SCIP_TRJ_WEIGHTSCHEMES) */
+#define DEFAULT_MAXSAMPLES      0            /**< maximum number of examples written per selection (0: no limit) */
+#define DEFAULT_MAXINSTSAMPLES  0            /**< maximum number of examples written per instance (0: no limit) */
 
 /*
  * Data structures
@@ -45,16 +49,22 @@ struct SCIP_NodeselData
    char*              polfname;           /**< name of the solution file */
    SCIP_POLICY*       policy;
    char*              trjfname;           /**< name of the trajectory file */
-   FILE*              wfile;
-   FILE*              trjfile;
+   SCIP_TRJ*          trj;                /**< trajectory examples are written to */
+   char               weightscheme;       /**< weighting scheme of examples */
    SCIP_FEAT*         feat;
    SCIP_FEAT*         optfeat;
 #ifndef NDEBUG
    SCIP_Longint       optnodenumber;      /**< successively assigned number of the node */
 #endif
    SCIP_Bool          negate;
-   int                nerrors;            /**< number of wrong ranking of a pair of nodes */
-   int                ncomps;              /**< total number of comparisons */
+   SCIP_Longint       optopennumber;      /**< number of the open optimal node, or -1 if none is open; it lies on the
+                                            *   optimal path, so at most one is open */
+   SCIP_Real          optopenbound;       /**< lower bound of the open optimal node, to notice its cutoff */
+   int                nerrors;            /**< number of selections of a non-optimal node while an optimal node was open */
+   int                nselections;        /**< number of selections while an optimal node was open */
+   int                maxsamples;         /**< maximum number of examples written per selection (0: no limit) */
+   int                maxinstsamples;     /**< maximum number of examples written per instance (0: no limit) */
+   SCIP_FEATOPTS      featopts;           /**< optional families of features appended to the node features */
 };
 
 void SCIPnodeseldaggerPrintStatistics(
@@ -74,7 +84,7 @@ void SCIPnodeseldaggerPrintStatistics(
    SCIPmessageFPrintInfo(scip->messagehdlr, file,
          "Node selector      :\n");
    SCIPmessageFPrintInfo(scip->messagehdlr, file,
-         "  comp error rate  : %d/%d\n", nodeseldata->nerrors, nodeseldata->ncomps);
+         "  sel error rate   : %d/%d\n", nodeseldata->nerrors, nodeseldata->nselections);
    SCIPmessageFPrintInfo(scip->messagehdlr, file,
          "  selection time   : %10.2f\n", SCIPnodeselGetTime(nodesel));
 }
@@ -102,40 +112,43 @@ SCIP_DECL_NODESELINIT(nodeselInitDagger)
    /* read policy */
    SCIP_CALL( SCIPpolicyCreate(scip, &nodeseldata->policy) );
    assert(nodeseldata->polfname != NULL);
-   SCIP_CALL( SCIPreadLIBSVMPolicy(scip, nodeseldata->polfname, &nodeseldata->policy) );
-   assert(nodeseldata->policy->weights != NULL);
-
-   /* open trajectory file for writing */
-   /* open in appending mode for writing training file from multiple problems */
-   nodeseldata->trjfile = NULL;
-   if( nodeseldata->trjfname != NULL )
-   {
-      char wfname[SCIP_MAXSTRLEN];
-      strcpy(wfname, nodeseldata->trjfname);
-      strcat(wfname, ".weight");
-      nodeseldata->wfile = fopen(wfname, "a");
-      nodeseldata->trjfile = fopen(nodeseldata->trjfname, "a");
-   }
+   SCIP_CALL( SCIPreadPolicy(scip, nodeseldata->polfname, &nodeseldata->policy) );
+   SCIP_CALL( SCIPpolicyCheckPairwise(scip, nodeseldata->policy, nodeseldata->polfname) );
 
    /* create feat */
    nodeseldata->feat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeseldata->feat, SCIP_FEATNODESEL_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeseldata->feat, SCIP_FEATNODESEL_SIZE, &nodeseldata->featopts) );
    assert(nodeseldata->feat != NULL);
    SCIPfeatSetMaxDepth(nodeseldata->feat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
 
+   /* the normalization of the policy must match the features of a node, including the optional ones */
+   SCIP_CALL( SCIPpolicyCheckFeatSize(scip, nodeseldata->policy, SCIPfeatGetSize(nodeseldata->feat), nodeseldata->polfname) );
+
    /* create optimal node feat */
    nodeseldata->optfeat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeseldata->optfeat, SCIP_FEATNODESEL_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeseldata->optfeat, SCIP_FEATNODESEL_SIZE, &nodeseldata->featopts) );
    assert(nodeseldata->optfeat != NULL);
    SCIPfeatSetMaxDepth(nodeseldata->optfeat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
+   SCIPfeatSharePaths(nodeseldata->optfeat, nodeseldata->feat);
+
+   /* open trajectory file for writing */
+   /* open in appending mode for writing training file from multiple problems */
+   nodeseldata->trj = NULL;
+   if( nodeseldata->trjfname != NULL && nodeseldata->trjfname[0] != '\0' )
+   {
+      SCIP_CALL( SCIPtrjCreate(scip, &nodeseldata->trj, nodeseldata->trjfname, SCIPfeatGetSize(nodeseldata->feat),
+            nodeseldata->maxinstsamples, nodeseldata->weightscheme, 0.0) );
+   }
 
 #ifndef NDEBUG
    nodeseldata->optnodenumber = -1;
 #endif
    nodeseldata->negate = TRUE;
 
+   nodeseldata->optopennumber = -1;
+   nodeseldata->optopenbound = -SCIPinfinity(scip);
    nodeseldata->nerrors = 0;
-   nodeseldata->ncomps = 0;
+   nodeseldata->nselections = 0;
 
    return SCIP_OKAY;
 }
@@ -153,10 +166,9 @@ SCIP_DECL_NODESELEXIT(nodeselExitDagger)
    assert(nodeseldata->optsol != NULL);
    SCIP_CALL( SCIPfreeSolSelf(scip, &nodeseldata->optsol) );
 
-   if( nodeseldata->trjfile != NULL)
+   if( nodeseldata->trj != NULL )
    {
-      fclose(nodeseldata->wfile);
-      fclose(nodeseldata->trjfile);
+      SCIP_CALL( SCIPtrjFree(scip, &nodeseldata->trj) );
    }
 
    assert(nodeseldata->feat != NULL);
@@ -186,6 +198,73 @@ SCIP_DECL_NODESELFREE(nodeselFreeDagger)
    return SCIP_OKAY;
 }
 
+/** write pairwise examples of the optimal node against the other open nodes */
+static
+SCIP_RETCODE writeExamples(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_NODESELDATA*     nodeseldata,        /**< node selector data */
+   SCIP_NODE**           leaves,             /**< open leaves */
+   SCIP_NODE**           children,           /**< children of the focus node */
+   SCIP_NODE**           siblings,           /**< siblings of the focus node */
+   int                   nleaves,            /**< number of leaves */
+   int                   nchildren,          /**< number of children */
+   int                   nsiblings,          /**< number of siblings */
+   int                   optchild            /**< index of the optimal child, or -1 */
+   )
+{
+   SCIP_NODE** nodes;
+   SCIP_Real* mults;
+   int nnodes;
+   int i;
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &nodes, nchildren + nsiblings + nleaves) );
+   nnodes = 0;
+
+   if( optchild != -1 )
+   {
+      /* new optimal node: rank it above all other open nodes */
+      SCIPcalcNodeselFeat(scip, children[optchild], nodeseldata->optfeat);
+      for( i = 0; i < nchildren; i++ )
+      {
+         if( i != optchild )
+            nodes[nnodes++] = children[i];
+      }
+      for( i = 0; i < nsiblings; i++ )
+         nodes[nnodes++] = siblings[i];
+      for( i = 0; i < nleaves; i++ )
+         nodes[nnodes++] = leaves[i];
+   }
+   else
+   {
+      /* children are not optimal */
+      assert(nchildren == 0 || (nchildren > 0 && nodeseldata->optnodenumber != -1));
+      for( i = 0; i < nchildren; i++ )
+         nodes[nnodes++] = children[i];
+   }
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &mults, nnodes) );
+   SCIP_CALL( SCIPtrjSampleNodes(scip, nodeseldata->trj, nodes, nnodes, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip),
+         nodeseldata->maxsamples, mults) );
+
+   for( i = 0; i < nnodes; i++ )
+   {
+      if( mults[i] == 0.0 )
+         continue;
+      SCIPcalcNodeselFeat(scip, nodes[i], nodeseldata->feat);
+      nodeseldata->negate ^= 1;
+#ifndef NDEBUG
+      SCIPdebugMessage("example  #%d #%d\n", (int)nodeseldata->optnodenumber, (int)SCIPnodeGetNumber(nodes[i]));
+#endif
+      SCIP_CALL( SCIPtrjAddFeatDiff(scip, nodeseldata->trj, nodeseldata->optfeat, nodeseldata->feat, nodes[i], 1,
+            nodeseldata->negate, mults[i]) );
+   }
+
+   SCIPfreeBufferArray(scip, &mults);
+   SCIPfreeBufferArray(scip, &nodes);
+
+   return SCIP_OKAY;
+}
+
 /** node selection method of node selector */
 static
 SCIP_DECL_NODESELSELECT(nodeselSelectDagger)
@@ -208,6 +287,12 @@ SCIP_DECL_NODESELSELECT(nodeselSelectDagger)
    nodeseldata = SCIPnodeselGetData(nodesel);
    assert(nodeseldata != NULL);
 
+   /* the focus node has been processed: count it in the subtrees of its ancestors */
+   if( nodeseldata->trj != NULL )
+   {
+      SCIP_CALL( SCIPtrjCountFocus(scip, nodeseldata->trj, SCIPgetCurrentNode(scip)) );
+   }
+
    /* collect leaves, children and siblings data */
    SCIP_CALL( SCIPgetOpenNodesData(scip, &leaves, &children, &siblings, &nleaves, &nchildren, &nsiblings) );
 
@@ -217,7 +302,7 @@ SCIP_DECL_NODESELSELECT(nodeselSelectDagger)
    {
       /* compute score */
       SCIPcalcNodeselFeat(scip, children[i], nodeseldata->feat);
-      SCIPcalcNodeScore(children[i], nodeseldata->feat, nodeseldata->policy);
+      SCIPcalcNodeSortKey(scip, children[i], nodeseldata->feat, nodeseldata->policy);
 
       /* check optimality */
       if( ! SCIPnodeIsOptchecked(children[i]) )
@@ -231,66 +316,34 @@ SCIP_DECL_NODESELSELECT(nodeselSelectDagger)
          SCIPdebugMessage("opt node #%"SCIP_LONGINT_FORMAT"\n", SCIPnodeGetNumber(children[i]));
          nodeseldata->optnodenumber = SCIPnodeGetNumber(children[i]);
 #endif
+         nodeseldata->optopennumber = SCIPnodeGetNumber(children[i]);
+         nodeseldata->optopenbound = SCIPnodeGetLowerbound(children[i]);
          optchild = i;
       }
    }
 
    /* write examples */
-   if( nodeseldata->trjfile != NULL )
+   if( nodeseldata->trj != NULL )
    {
-      if( optchild != -1 )
-      {
-         /* new optimal node */
-         SCIPcalcNodeselFeat(scip, children[optchild], nodeseldata->optfeat);
-         for( i = 0; i < nchildren; i++)
-         {
-            if( i != optchild )
-            {
-               SCIPcalcNodeselFeat(scip, children[i], nodeseldata->feat);
-               nodeseldata->negate ^= 1;
-#ifndef NDEBUG
-               SCIPdebugMessage("example  #%d #%d\n", (int)nodeseldata->optnodenumber, (int)SCIPnodeGetNumber(children[i]));
-#endif
-               SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-            }
-         }
-         for( i = 0; i < nsiblings; i++ )
-         {
-            SCIPcalcNodeselFeat(scip, siblings[i], nodeseldata->feat);
-            nodeseldata->negate ^= 1;
-#ifndef NDEBUG
-            SCIPdebugMessage("example  #%d #%d\n", (int)nodeseldata->optnodenumber, (int)SCIPnodeGetNumber(siblings[i]));
-#endif
-            SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-         }
-         for( i = 0; i < nleaves; i++ )
-         {
-            SCIPcalcNodeselFeat(scip, leaves[i], nodeseldata->feat);
-            nodeseldata->negate ^= 1;
-#ifndef NDEBUG
-            SCIPdebugMessage("example  #%d #%d\n", (int)nodeseldata->optnodenumber, (int)SCIPnodeGetNumber(leaves[i]));
-#endif
-            SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-         }
-      }
-      else
-      {
-         /* children are not optimal */
-         assert(nchildren == 0 || (nchildren > 0 && nodeseldata->optnodenumber != -1));
-         for( i = 0; i < nchildren; i++ )
-         {
-            SCIPcalcNodeselFeat(scip, children[i], nodeseldata->feat);
-            nodeseldata->negate ^= 1;
-#ifndef NDEBUG
-            SCIPdebugMessage("example  #%d #%d\n", (int)nodeseldata->optnodenumber, (int)SCIPnodeGetNumber(children[i]));
-#endif
-            SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-         }
-      }
+      SCIP_CALL( writeExamples(scip, nodeseldata, leaves, children, siblings, nleaves, nchildren, nsiblings, optchild) );
    }
 
    *selnode = SCIPgetBestNode(scip);
 
+   /* evaluate the selection against the open optimal node; it is no longer open once it is selected or its lower bound
+    * reaches the cutoff bound (a node pruner removing it is not noticed)
+    */
+   if( nodeseldata->optopennumber != -1 && SCIPisGE(scip, nodeseldata->optopenbound, SCIPgetCutoffbound(scip)) )
+      nodeseldata->optopennumber = -1;
+   if( *selnode != NULL && nodeseldata->optopennumber != -1 )
+   {
+      nodeseldata->nselections++;
+      if( SCIPnodeGetNumber(*selnode) == nodeseldata->optopennumber )
+         nodeseldata->optopennumber = -1;
+      else
+         nodeseldata->nerrors++;
+   }
+
    return SCIP_OKAY;
 }
 
@@ -300,66 +353,21 @@ SCIP_DECL_NODESELCOMP(nodeselCompDagger)
 {  /*lint --e{715}*/
    SCIP_Real score1;
    SCIP_Real score2;
-   SCIP_Bool isopt1;
-   SCIP_Bool isopt2;
-   SCIP_NODESELDATA* nodeseldata;
-   int result;
 
    assert(nodesel != NULL);
    assert(strcmp(SCIPnodeselGetName(nodesel), NODESEL_NAME) == 0);
    assert(scip != NULL);
 
-   assert(SCIPnodeIsOptchecked(node1) == TRUE);
-   assert(SCIPnodeIsOptchecked(node2) == TRUE);
-
+   /* scores are sort keys of policy score, depth and lower bound (see SCIPcalcNodeSortKey()) */
    score1 = SCIPnodeGetScore(node1);
    score2 = SCIPnodeGetScore(node2);
 
-   assert(score1 != 0);
-   assert(score2 != 0);
-
-   if( SCIPisGT(scip, score1, score2) )
-      result = -1;
-   else if( SCIPisLT(scip, score1, score2) )
-      result = +1;
+   if( score1 > score2 )
+      return -1;
+   else if( score1 < score2 )
+      return +1;
    else
-   {
-      int depth1;
-      int depth2;
-
-      depth1 = SCIPnodeGetDepth(node1);
-      depth2 = SCIPnodeGetDepth(node2);
-      if( depth1 > depth2 )
-         result = -1;
-      else if( depth1 < depth2 )
-         result = +1;
-      else
-      {
-         SCIP_Real lowerbound1;
-         SCIP_Real lowerbound2;
-
-         lowerbound1 = SCIPnodeGetLowerbound(node1);
-         lowerbound2 = SCIPnodeGetLowerbound(node2);
-         if( SCIPisLT(scip, lowerbound1, lowerbound2) )
-            result = -1;
-         else if( SCIPisGT(scip, lowerbound1, lowerbound2) )
-            result = +1;
-         else
-            result = 0;
-      }
-   }
-
-   nodeseldata = SCIPnodeselGetData(nodesel);
-   assert(nodeseldata != NULL);
-   isopt1 = SCIPnodeIsOptimal(node1);
-   isopt2 = SCIPnodeIsOptimal(node2);
-   if( (isopt1 && result == 1) || (isopt2 && result == -1) )
-      nodeseldata->nerrors++;
-   /* don't count the case when neither node is opt, in which case it will always be correct */
-   if( isopt1 || isopt2 )
-      nodeseldata->ncomps++;
-
-   return result;
+      return 0;
 }
 
 /*
@@ -406,10 +414,23 @@ SCIP_RETCODE SCIPincludeNodeselDagger(
          "nodeselection/"NODESEL_NAME"/trjfname",
          "name of the file to write node selection trajectories",
          &nodeseldata->trjfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddCharParam(scip,
+         "nodeselection/"NODESEL_NAME"/weightscheme",
+         "weighting scheme of examples, normalized to mean one per instance ('d'epth decay, 'u'niform, inverse 'f'requency of depth and bound type, 's'ubtree size)",
+         &nodeseldata->weightscheme, FALSE, DEFAULT_WEIGHTSCHEME, SCIP_TRJ_WEIGHTSCHEMES, NULL, NULL) );
    SCIP_CALL( SCIPaddStringParam(scip,
          "nodeselection/"NODESEL_NAME"/polfname",
          "name of the policy model file",
          &nodeseldata->polfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodeselection/"NODESEL_NAME"/maxsamples",
+         "maximum number of examples written per selection, sampled by node type and depth (0: no limit)",
+         &nodeseldata->maxsamples, FALSE, DEFAULT_MAXSAMPLES, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodeselection/"NODESEL_NAME"/maxinstsamples",
+         "maximum number of examples written per instance, kept by reservoir sampling (0: no limit)",
+         &nodeseldata->maxinstsamples, FALSE, DEFAULT_MAXINSTSAMPLES, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPfeatAddOptsParams(scip, "nodeselection/"NODESEL_NAME, &nodeseldata->featopts) );
 
    return SCIP_OKAY;
 }
@@ -18,6 +18,7 @@
 #include <string.h>
 #include "nodesel_oracle.h"
 #include "feat.h"
+#include "trj.h"
 #include "scip/sol.h"
 #include "scip/tree.h"
 #include "scip/struct_set.h"
@@ -29,6 +30,9 @@
 #define NODESEL_MEMSAVEPRIORITY 0
 
 #define DEFAULT_FILENAME        ""
+#define DEFAULT_WEIGHTSCHEME    'd'          /**< weighting scheme of examples (see SCIP_TRJ_WEIGHTSCHEMES) */
+#define DEFAULT_MAXSAMPLES      0            /**< maximum number of examples written per selection (0: no limit) */
+#define DEFAULT_MAXINSTSAMPLES  0            /**< maximum number of examples written per instance (0: no limit) */
 
 /*
  * Data structures
@@ -40,14 +44,17 @@ struct SCIP_NodeselData
    SCIP_SOL*          optsol;             /**< optimal solution */
    char*              solfname;           /**< name of the solution file */
    char*              trjfname;           /**< name of the trajectory file */
-   FILE*              trjfile;
-   FILE*              wfile;
+   SCIP_TRJ*          trj;                /**< trajectory examples are written to */
+   char               weightscheme;       /**< weighting scheme of examples */
    SCIP_FEAT*         feat;
    SCIP_FEAT*         optfeat;
 #ifndef NDEBUG
    SCIP_Longint       optnodenumber;      /**< successively assigned number of the node */
 #endif
    SCIP_Bool          negate;
+   int                maxsamples;         /**< maximum number of examples written per selection (0: no limit) */
+   int                maxinstsamples;     /**< maximum number of examples written per instance (0: no limit) */
+   SCIP_FEATOPTS      featopts;           /**< optional families of features appended to the node features */
 };
 
 
@@ -322,27 +329,25 @@ SCIP_DECL_NODESELINIT(nodeselInitOracle)
    SCIP_CALL( SCIPprintSol(scip, nodeseldata->optsol, NULL, FALSE) );
 #endif
 
-   nodeseldata->trjfile = NULL;
-   if( nodeseldata->trjfname != NULL )
-   {
-      char wfname[SCIP_MAXSTRLEN];
-      strcpy(wfname, nodeseldata->trjfname);
-      strcat(wfname, ".weight");
-      nodeseldata->wfile = fopen(wfname, "a");
-      nodeseldata->trjfile = fopen(nodeseldata->trjfname, "a");
-   }
-
    /* create feat */
    nodeseldata->feat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeseldata->feat, SCIP_FEATNODESEL_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeseldata->feat, SCIP_FEATNODESEL_SIZE, &nodeseldata->featopts) );
    assert(nodeseldata->feat != NULL);
    SCIPfeatSetMaxDepth(nodeseldata->feat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
 
    /* create optimal node feat */
    nodeseldata->optfeat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeseldata->optfeat, SCIP_FEATNODESEL_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeseldata->optfeat, SCIP_FEATNODESEL_SIZE, &nodeseldata->featopts) );
    assert(nodeseldata->optfeat != NULL);
    SCIPfeatSetMaxDepth(nodeseldata->optfeat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
+   SCIPfeatSharePaths(nodeseldata->optfeat, nodeseldata->feat);
+
+   nodeseldata->trj = NULL;
+   if( nodeseldata->trjfname != NULL && nodeseldata->trjfname[0] != '\0' )
+   {
+      SCIP_CALL( SCIPtrjCreate(scip, &nodeseldata->trj, nodeseldata->trjfname, SCIPfeatGetSize(nodeseldata->feat),
+            nodeseldata->maxinstsamples, nodeseldata->weightscheme, 0.0) );
+   }
 
 #ifndef NDEBUG
    nodeseldata->optnodenumber = -1;
@@ -366,12 +371,10 @@ SCIP_DECL_NODESELEXIT(nodeselExitOracle)
    SCIP_CALL( SCIPfreeSolSelf(scip, &nodeseldata->optsol) );
    nodeseldata->optsol = NULL;
 
-   if( nodeseldata->trjfile != NULL)
+   if( nodeseldata->trj != NULL )
    {
-      fclose(nodeseldata->wfile);
-      fclose(nodeseldata->trjfile);
-      nodeseldata->wfile = NULL;
-      nodeseldata->trjfile = NULL;
+      SCIP_CALL( SCIPtrjFree(scip, &nodeseldata->trj) );
+      nodeseldata->trj = NULL;
    }
 
    if( nodeseldata->feat != NULL )
@@ -409,6 +412,72 @@ SCIP_DECL_NODESELFREE(nodeselFreeOracle)
    return SCIP_OKAY;
 }
 
+/** write pairwise examples of the optimal node against the other open nodes */
+static
+SCIP_RETCODE writeExamples(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_NODESELDATA*     nodeseldata,        /**< node selector data */
+   SCIP_NODE**           leaves,             /**< open leaves */
+   SCIP_NODE**           children,           /**< children of the focus node */
+   SCIP_NODE**           siblings,           /**< siblings of the focus node */
+   int                   nleaves,            /**< number of leaves */
+   int                   nchildren,          /**< number of children */
+   int                   nsiblings,          /**< number of siblings */
+   int                   optchild            /**< index of the optimal child, or -1 */
+   )
+{
+   SCIP_NODE** nodes;
+   SCIP_Real* mults;
+   int nnodes;
+   int i;
+
+   SCIPdebugMessage("node selection feature\n");
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &nodes, nchildren + nsiblings + nleaves) );
+   nnodes = 0;
+
+   if( optchild != -1 )
+   {
+      /* new optimal node: rank it above all other open nodes */
+      SCIPcalcNodeselFeat(scip, children[optchild], nodeseldata->optfeat);
+      for( i = 0; i < nchildren; i++ )
+      {
+         if( i != optchild )
+            nodes[nnodes++] = children[i];
+      }
+      for( i = 0; i < nsiblings; i++ )
+         nodes[nnodes++] = siblings[i];
+      for( i = 0; i < nleaves; i++ )
+         nodes[nnodes++] = leaves[i];
+   }
+   else
+   {
+      /* children are not optimal */
+      assert(nchildren == 0 || (nchildren > 0 && nodeseldata->optnodenumber != -1));
+      for( i = 0; i < nchildren; i++ )
+         nodes[nnodes++] = children[i];
+   }
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &mults, nnodes) );
+   SCIP_CALL( SCIPtrjSampleNodes(scip, nodeseldata->trj, nodes, nnodes, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip),
+         nodeseldata->maxsamples, mults) );
+
+   for( i = 0; i < nnodes; i++ )
+   {
+      if( mults[i] == 0.0 )
+         continue;
+      SCIPcalcNodeselFeat(scip, nodes[i], nodeseldata->feat);
+      nodeseldata->negate ^= 1;
+      SCIP_CALL( SCIPtrjAddFeatDiff(scip, nodeseldata->trj, nodeseldata->optfeat, nodeseldata->feat, nodes[i], 1,
+            nodeseldata->negate, mults[i]) );
+   }
+
+   SCIPfreeBufferArray(scip, &mults);
+   SCIPfreeBufferArray(scip, &nodes);
+
+   return SCIP_OKAY;
+}
+
 /** node selection method of node selector */
 static
 SCIP_DECL_NODESELSELECT(nodeselSelectOracle)
@@ -431,6 +500,12 @@ SCIP_DECL_NODESELSELECT(nodeselSelectOracle)
    nodeseldata = SCIPnodeselGetData(nodesel);
    assert(nodeseldata != NULL);
 
+   /* the focus node has been processed: count it in the subtrees of its ancestors */
+   if( nodeseldata->trj != NULL )
+   {
+      SCIP_CALL( SCIPtrjCountFocus(scip, nodeseldata->trj, SCIPgetCurrentNode(scip)) );
+   }
+
    /* collect leaves, children and siblings data */
    SCIP_CALL( SCIPgetOpenNodesData(scip, &leaves, &children, &siblings, &nleaves, &nchildren, &nsiblings) );
 
@@ -458,51 +533,10 @@ SCIP_DECL_NODESELSELECT(nodeselSelectOracle)
    }
 
    /* write examples */
-#ifndef SCIP_DEBUG
-   if( nodeseldata->trjfile != NULL )
+   if( nodeseldata->trj != NULL )
    {
-#endif
-      SCIPdebugMessage("node selection feature\n");
-      if( optchild != -1 )
-      {
-         /* new optimal node */
-         SCIPcalcNodeselFeat(scip, children[optchild], nodeseldata->optfeat);
-         for( i = 0; i < nchildren; i++)
-         {
-            if( i != optchild )
-            {
-               SCIPcalcNodeselFeat(scip, children[i], nodeseldata->feat);
-               nodeseldata->negate ^= 1;
-               SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-            }
-         }
-         for( i = 0; i < nsiblings; i++ )
-         {
-            SCIPcalcNodeselFeat(scip, siblings[i], nodeseldata->feat);
-            nodeseldata->negate ^= 1;
-            SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-         }
-         for( i = 0; i < nleaves; i++ )
-         {
-            SCIPcalcNodeselFeat(scip, leaves[i], nodeseldata->feat);
-            nodeseldata->negate ^= 1;
-            SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-         }
-      }
-      else
-      {
-         /* children are not optimal */
-         assert(nchildren == 0 || (nchildren > 0 && nodeseldata->optnodenumber != -1));
-         for( i = 0; i < nchildren; i++ )
-         {
-            SCIPcalcNodeselFeat(scip, children[i], nodeseldata->feat);
-            nodeseldata->negate ^= 1;
-            SCIPfeatDiffLIBSVMPrint(scip, nodeseldata->trjfile, nodeseldata->wfile, nodeseldata->optfeat, nodeseldata->feat, 1, nodeseldata->negate);
-         }
-      }
-#ifndef SCIP_DEBUG
+      SCIP_CALL( writeExamples(scip, nodeseldata, leaves, children, siblings, nleaves, nchildren, nsiblings, optchild) );
    }
-#endif
 
    *selnode = SCIPgetBestNode(scip);
 
@@ -609,6 +643,19 @@ SCIP_RETCODE SCIPincludeNodeselOracle(
          "nodeselection/"NODESEL_NAME"/trjfname",
          "name of the file to write node selection trajectories",
          &nodeseldata->trjfname, TRUE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddCharParam(scip,
+         "nodeselection/"NODESEL_NAME"/weightscheme",
+         "weighting scheme of examples, normalized to mean one per instance ('d'epth decay, 'u'niform, inverse 'f'requency of depth and bound type, 's'ubtree size)",
+         &nodeseldata->weightscheme, TRUE, DEFAULT_WEIGHTSCHEME, SCIP_TRJ_WEIGHTSCHEMES, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodeselection/"NODESEL_NAME"/maxsamples",
+         "maximum number of examples written per selection, sampled by node type and depth (0: no limit)",
+         &nodeseldata->maxsamples, TRUE, DEFAULT_MAXSAMPLES, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodeselection/"NODESEL_NAME"/maxinstsamples",
+         "maximum number of examples written per instance, kept by reservoir sampling (0: no limit)",
+         &nodeseldata->maxinstsamples, TRUE, DEFAULT_MAXINSTSAMPLES, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPfeatAddOptsParams(scip, "nodeselection/"NODESEL_NAME, &nodeseldata->featopts) );
 
    return SCIP_OKAY;
 }
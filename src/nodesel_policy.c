@@ -14,18 +14,29 @@
 #include "nodesel_oracle.h"
 #include "feat.h"
 #include "policy.h"
+#include "opentree.h"
+#include "nodepru_policy.h"
+#include "nodepru_dagger.h"
 #include "struct_policy.h"
 #include "scip/sol.h"
 #include "scip/tree.h"
+#include "scip/nodesel.h"
+#include "scip/struct_mem.h"
 #include "scip/struct_set.h"
+#include "scip/struct_stat.h"
 #include "scip/struct_scip.h"
 
 #define NODESEL_NAME            "policy"
 #define NODESEL_DESC            "node selector which selects node according to a policy"
 #define NODESEL_STDPRIORITY     10
-#define NODESEL_MEMSAVEPRIORITY 0
+#define NODESEL_MEMSAVEPRIORITY 200000       /**< above depth first search, which SCIP uses in memory saving mode */
 
 #define DEFAULT_FILENAME        ""
+#define DEFAULT_BEAMWIDTH       0            /**< maximum number of open nodes kept (0: no beam) */
+#define DEFAULT_BEAMMODE        'r'          /**< selection of a node in the beam ('r'ound robin, 'd'iversity) */
+#define BEAMMAPFACTOR           4            /**< size of the map of beam node numbers relative to the beam width */
+#define DEFAULT_PLUNGEMARGIN    -1.0         /**< margin of policy score by which the best child has to beat the best
+                                              *   leaf and sibling to be selected directly (negative: no plunging) */
 
 /*
  * Data structures
@@ -37,6 +48,21 @@ struct SCIP_NodeselData
    char*              polfname;           /**< name of the solution file */
    SCIP_POLICY*       policy;
    SCIP_FEAT*         feat;
+   int                beamwidth;          /**< maximum number of open nodes kept (0: no beam) */
+   char               beammode;           /**< selection of a node in the beam ('r'ound robin, 'd'iversity) */
+   SCIP_NODE**        beam;               /**< open nodes with the largest sort keys, a min-heap while it is filled */
+   SCIP_Real*         beamkeys;           /**< sort keys of the nodes in the beam */
+   SCIP_HASHMAP*      beammap;            /**< numbers of the nodes in the beam */
+   SCIP_Real          lastbeamkey;        /**< sort key of the last node selected round robin, or infinity */
+   SCIP_Longint       lastparent;         /**< number of the parent of the last selected node, or -1 */
+   int                nevicted;           /**< number of leaves evicted from the beam */
+   SCIP_Real          plungemargin;       /**< margin of policy score for selecting the best child directly */
+   int                nplunges;           /**< number of children selected directly */
+   int                nmemsavesels;       /**< number of selections in memory saving mode */
+   SCIP_FEATOPTS      featopts;           /**< optional families of features appended to the node features */
+#ifdef SCIP_STATISTIC
+   SCIP_Longint       ncomps;             /**< number of node comparisons */
+#endif
 };
 
 void SCIPnodeselpolicyPrintStatistics(
@@ -50,8 +76,19 @@ void SCIPnodeselpolicyPrintStatistics(
 
    SCIPmessageFPrintInfo(scip->messagehdlr, file, 
          "Node selector      :\n");
+   if( SCIPnodeselGetData(nodesel)->beamwidth > 0 )
+      SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  beam evictions   : %10d\n", SCIPnodeselGetData(nodesel)->nevicted);
+   if( SCIPnodeselGetData(nodesel)->nmemsavesels > 0 )
+      SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  memsave selects  : %10d\n", SCIPnodeselGetData(nodesel)->nmemsavesels);
+   if( SCIPnodeselGetData(nodesel)->plungemargin >= 0.0 )
+      SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  plunges          : %10d\n", SCIPnodeselGetData(nodesel)->nplunges);
    SCIPmessageFPrintInfo(scip->messagehdlr, file, 
          "  selection time   : %10.2f\n", SCIPnodeselGetTime(nodesel));
+   SCIPstatistic( SCIPmessageFPrintInfo(scip->messagehdlr, file,
+         "  comparisons      : %10"SCIP_LONGINT_FORMAT"\n", SCIPnodeselGetData(nodesel)->ncomps) );
 }
 
 /** solving process initialization method of node selector (called when branch and bound process is about to begin) */
@@ -68,14 +105,35 @@ SCIP_DECL_NODESELINIT(nodeselInitPolicy)
    /* read policy */
    SCIP_CALL( SCIPpolicyCreate(scip, &nodeseldata->policy) );
    assert(nodeseldata->polfname != NULL);
-   SCIP_CALL( SCIPreadLIBSVMPolicy(scip, nodeseldata->polfname, &nodeseldata->policy) );
-   assert(nodeseldata->policy->weights != NULL);
+   SCIP_CALL( SCIPreadPolicy(scip, nodeseldata->polfname, &nodeseldata->policy) );
+   SCIP_CALL( SCIPpolicyCheckPairwise(scip, nodeseldata->policy, nodeseldata->polfname) );
   
    /* create feat */
    nodeseldata->feat = NULL;
-   SCIP_CALL( SCIPfeatCreate(scip, &nodeseldata->feat, SCIP_FEATNODESEL_SIZE) );
+   SCIP_CALL( SCIPfeatCreateExt(scip, &nodeseldata->feat, SCIP_FEATNODESEL_SIZE, &nodeseldata->featopts) );
    assert(nodeseldata->feat != NULL);
    SCIPfeatSetMaxDepth(nodeseldata->feat, SCIPgetNBinVars(scip) + SCIPgetNIntVars(scip));
+
+   /* the normalization of the policy must match the features of a node, including the optional ones */
+   SCIP_CALL( SCIPpolicyCheckFeatSize(scip, nodeseldata->policy, SCIPfeatGetSize(nodeseldata->feat), nodeseldata->polfname) );
+
+   SCIPstatistic( nodeseldata->ncomps = 0 );
+
+   nodeseldata->beam = NULL;
+   nodeseldata->beamkeys = NULL;
+   nodeseldata->beammap = NULL;
+   if( nodeseldata->beamwidth > 0 )
+   {
+      SCIP_CALL( SCIPallocMemoryArray(scip, &nodeseldata->beam, nodeseldata->beamwidth) );
+      SCIP_CALL( SCIPallocMemoryArray(scip, &nodeseldata->beamkeys, nodeseldata->beamwidth) );
+      SCIP_CALL( SCIPhashmapCreate(&nodeseldata->beammap, SCIPblkmem(scip),
+            SCIPcalcHashtableSize(BEAMMAPFACTOR * nodeseldata->beamwidth)) );
+   }
+   nodeseldata->lastbeamkey = SCIPinfinity(scip);
+   nodeseldata->lastparent = -1;
+   nodeseldata->nevicted = 0;
+   nodeseldata->nplunges = 0;
+   nodeseldata->nmemsavesels = 0;
   
    return SCIP_OKAY;
 }
@@ -95,6 +153,13 @@ SCIP_DECL_NODESELEXIT(nodeselExitPolicy)
 
    assert(nodeseldata->policy != NULL);
    SCIP_CALL( SCIPpolicyFree(scip, &nodeseldata->policy) );
+
+   if( nodeseldata->beam != NULL )
+   {
+      SCIPfreeMemoryArray(scip, &nodeseldata->beam);
+      SCIPfreeMemoryArray(scip, &nodeseldata->beamkeys);
+      SCIPhashmapFree(&nodeseldata->beammap);
+   }
    
    return SCIP_OKAY;
 }
@@ -115,13 +180,179 @@ SCIP_DECL_NODESELFREE(nodeselFreePolicy)
    return SCIP_OKAY;
 }
 
+/** add node to the beam min-heap of size at most beamwidth, replacing its smallest key if the beam is full */
+static
+void beamInsert(
+   SCIP_NODESELDATA*     nodeseldata,        /**< node selector data */
+   int*                  nbeam,              /**< number of nodes in the beam */
+   SCIP_NODE*            node                /**< node to insert */
+   )
+{
+   SCIP_NODE** beam = nodeseldata->beam;
+   SCIP_Real* keys = nodeseldata->beamkeys;
+   SCIP_Real key = SCIPnodeGetScore(node);
+   int pos;
+
+   if( *nbeam < nodeseldata->beamwidth )
+   {
+      /* sift up */
+      pos = (*nbeam)++;
+      while( pos > 0 && keys[(pos - 1) / 2] > key )
+      {
+         beam[pos] = beam[(pos - 1) / 2];
+         keys[pos] = keys[(pos - 1) / 2];
+         pos = (pos - 1) / 2;
+      }
+   }
+   else
+   {
+      if( key <= keys[0] )
+         return;
+
+      /* replace the smallest key and sift down */
+      pos = 0;
+      while( 2 * pos + 1 < *nbeam )
+      {
+         int child = 2 * pos + 1;
+
+         if( child + 1 < *nbeam && keys[child + 1] < keys[child] )
+            child++;
+         if( keys[child] >= key )
+            break;
+         beam[pos] = beam[child];
+         keys[pos] = keys[child];
+         pos = child;
+      }
+   }
+   beam[pos] = node;
+   keys[pos] = key;
+}
+
+/** keep the open nodes with the largest sort keys in the beam, sorted by decreasing key, and evict the leaves outside
+ *  of it; children and siblings outside of it are evicted once they become leaves
+ */
+static
+SCIP_RETCODE updateBeam(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_NODESELDATA*     nodeseldata,        /**< node selector data */
+   int*                  nbeam               /**< pointer to store the number of nodes in the beam */
+   )
+{
+   SCIP_NODE** leaves;
+   SCIP_NODE** children;
+   SCIP_NODE** siblings;
+   SCIP_NODE** evict;
+   SCIP_NODEPRU* nodepru;
+   SCIP_COLDSTORE* coldstore;
+   int nleaves;
+   int nchildren;
+   int nsiblings;
+   int nevict;
+   int i;
+
+   SCIP_CALL( SCIPgetOpenNodesData(scip, &leaves, &children, &siblings, &nleaves, &nchildren, &nsiblings) );
+
+   *nbeam = 0;
+   for( i = 0; i < nchildren; i++ )
+      beamInsert(nodeseldata, nbeam, children[i]);
+   for( i = 0; i < nsiblings; i++ )
+      beamInsert(nodeseldata, nbeam, siblings[i]);
+   for( i = 0; i < nleaves; i++ )
+      beamInsert(nodeseldata, nbeam, leaves[i]);
+   SCIPsortDownRealPtr(nodeseldata->beamkeys, (void**)nodeseldata->beam, *nbeam);
+
+   if( *nbeam == 0 || nleaves + nchildren + nsiblings == *nbeam )
+      return SCIP_OKAY;
+
+   SCIP_CALL( SCIPhashmapRemoveAll(nodeseldata->beammap) );
+   for( i = 0; i < *nbeam; i++ )
+   {
+      SCIP_CALL( SCIPhashmapInsert(nodeseldata->beammap, (void*)(size_t)SCIPnodeGetNumber(nodeseldata->beam[i]),
+            (void*)(size_t)1) );
+   }
+
+   /* collect the leaves first, since the eviction rebuilds the leaf queue */
+   SCIP_CALL( SCIPallocBufferArray(scip, &evict, nleaves) );
+   nevict = 0;
+   for( i = 0; i < nleaves; i++ )
+   {
+      if( !SCIPhashmapExists(nodeseldata->beammap, (void*)(size_t)SCIPnodeGetNumber(leaves[i])) )
+         evict[nevict++] = leaves[i];
+   }
+
+   /* with softprune on, the node pruner parks the evicted leaves, so that they can be revisited */
+   coldstore = NULL;
+   nodepru = SCIPgetNodepru(scip);
+   if( nodepru != NULL && strcmp(SCIPnodepruGetName(nodepru), "policy") == 0 )
+      coldstore = SCIPnodeprupolicyGetColdstore(nodepru);
+   else if( nodepru != NULL && strcmp(SCIPnodepruGetName(nodepru), "dagger") == 0 )
+      coldstore = SCIPnodeprudaggerGetColdstore(nodepru);
+   if( coldstore != NULL )
+   {
+      for( i = 0; i < nevict; i++ )
+      {
+         SCIP_CALL( SCIPcoldstoreAdd(scip, coldstore, evict[i], SCIPnodeGetScore(evict[i])) );
+      }
+   }
+
+   SCIP_CALL( SCIPevictLeaves(scip, evict, nevict) );
+   nodeseldata->nevicted += nevict;
+   SCIPfreeBufferArray(scip, &evict);
+
+   return SCIP_OKAY;
+}
+
+/** select a node of the beam, which is sorted by decreasing key */
+static
+SCIP_NODE* selectBeam(
+   SCIP_NODESELDATA*     nodeseldata,        /**< node selector data */
+   int                   nbeam               /**< number of nodes in the beam */
+   )
+{
+   SCIP_NODE* selnode;
+   int i;
+
+   assert(nbeam > 0);
+
+   if( nodeseldata->beammode == 'r' )
+   {
+      /* cycle through the beam by key: the next node below the last one served, or the best node after the last */
+      for( i = 0; i < nbeam && nodeseldata->beamkeys[i] >= nodeseldata->lastbeamkey; i++ );
+      if( i == nbeam )
+         i = 0;
+      selnode = nodeseldata->beam[i];
+      nodeseldata->lastbeamkey = nodeseldata->beamkeys[i];
+   }
+   else
+   {
+      /* take the best node that does not continue from the parent of the last selected node */
+      assert(nodeseldata->beammode == 'd');
+      selnode = nodeseldata->beam[0];
+      for( i = 0; i < nbeam; i++ )
+      {
+         SCIP_NODE* parent = SCIPnodeGetParent(nodeseldata->beam[i]);
+
+         if( parent == NULL || SCIPnodeGetNumber(parent) != nodeseldata->lastparent )
+         {
+            selnode = nodeseldata->beam[i];
+            break;
+         }
+      }
+   }
+   nodeseldata->lastparent = SCIPnodeGetParent(selnode) == NULL ? -1 : SCIPnodeGetNumber(SCIPnodeGetParent(selnode));
+
+   return selnode;
+}
+
 /** node selection method of node selector */
 static
 SCIP_DECL_NODESELSELECT(nodeselSelectPolicy)
 {
    SCIP_NODESELDATA* nodeseldata;
    SCIP_NODE** children;
+   SCIP_NODE* bestchild;
    int nchildren;
+   int nbeam;
    int i;
 
    assert(nodesel != NULL);
@@ -136,14 +367,66 @@ SCIP_DECL_NODESELSELECT(nodeselSelectPolicy)
    SCIP_CALL( SCIPgetChildren(scip, &children, &nchildren) );
 
    /* check newly created nodes */
+   bestchild = NULL;
    for( i = 0; i < nchildren; i++)
    {
       /* compute score */
       SCIPcalcNodeselFeat(scip, children[i], nodeseldata->feat);
-      SCIPcalcNodeScore(children[i], nodeseldata->feat, nodeseldata->policy);
+      SCIPcalcNodeSortKey(scip, children[i], nodeseldata->feat, nodeseldata->policy);
+      if( bestchild == NULL || SCIPnodeGetScore(children[i]) > SCIPnodeGetScore(bestchild) )
+         bestchild = children[i];
    }
 
-   *selnode = SCIPgetBestNode(scip);
+   /* bound the open nodes by the beam on every path, including plunging and memory saving mode */
+   nbeam = 0;
+   if( nodeseldata->beamwidth > 0 )
+   {
+      SCIP_CALL( updateBeam(scip, nodeseldata, &nbeam) );
+   }
+
+   /* in memory saving mode, dive depth first in the order of the policy: the best child, the best sibling, and the
+    * best leaf only if there are neither; this keeps the number of open nodes small
+    */
+   if( scip->stat->memsavemode )
+   {
+      nodeseldata->nmemsavesels++;
+      *selnode = bestchild;
+      if( *selnode == NULL )
+         *selnode = SCIPgetBestSibling(scip);
+      if( *selnode == NULL )
+         *selnode = SCIPgetBestLeaf(scip);
+      return SCIP_OKAY;
+   }
+
+   /* plunge into the best child if it beats the best leaf, which is the top of the leaf queue, and the best sibling
+    * by the margin; this keeps the warm LP and avoids comparisons in the leaf queue
+    */
+   if( nodeseldata->plungemargin >= 0.0 && bestchild != NULL )
+   {
+      SCIP_NODE* bestleaf;
+      SCIP_NODE* bestsibling;
+      SCIP_Real threshold;
+
+      threshold = -SCIPinfinity(scip);
+      bestleaf = SCIPgetBestLeaf(scip);
+      if( bestleaf != NULL )
+         threshold = SCIPsortKeyGetScore(SCIPnodeGetScore(bestleaf));
+      bestsibling = SCIPgetBestSibling(scip);
+      if( bestsibling != NULL )
+         threshold = MAX(threshold, SCIPsortKeyGetScore(SCIPnodeGetScore(bestsibling)));
+
+      if( SCIPsortKeyGetScore(SCIPnodeGetScore(bestchild)) > threshold + nodeseldata->plungemargin )
+      {
+         nodeseldata->nplunges++;
+         *selnode = bestchild;
+         return SCIP_OKAY;
+      }
+   }
+
+   if( nbeam > 0 )
+      *selnode = selectBeam(nodeseldata, nbeam);
+   else
+      *selnode = SCIPgetBestNode(scip);
 
    return SCIP_OKAY;
 }
@@ -159,42 +442,18 @@ SCIP_DECL_NODESELCOMP(nodeselCompPolicy)
    assert(strcmp(SCIPnodeselGetName(nodesel), NODESEL_NAME) == 0);
    assert(scip != NULL);
 
+   /* scores are sort keys of policy score, depth and lower bound (see SCIPcalcNodeSortKey()) */
    score1 = SCIPnodeGetScore(node1);
    score2 = SCIPnodeGetScore(node2);
 
-   assert(score1 != 0);
-   assert(score2 != 0);
+   SCIPstatistic( SCIPnodeselGetData(nodesel)->ncomps++ );
 
-   if( SCIPisGT(scip, score1, score2) )
+   if( score1 > score2 )
       return -1;
-   else if( SCIPisLT(scip, score1, score2) )
+   else if( score1 < score2 )
       return +1;
    else
-   {
-      int depth1;
-      int depth2;
-
-      depth1 = SCIPnodeGetDepth(node1);
-      depth2 = SCIPnodeGetDepth(node2);
-      if( depth1 > depth2 )
-         return -1;
-      else if( depth1 < depth2 )
-         return +1;
-      else
-      {
-         SCIP_Real lowerbound1;
-         SCIP_Real lowerbound2;
-
-         lowerbound1 = SCIPnodeGetLowerbound(node1);
-         lowerbound2 = SCIPnodeGetLowerbound(node2);
-         if( SCIPisLT(scip, lowerbound1, lowerbound2) )
-            return -1;
-         else if( SCIPisGT(scip, lowerbound1, lowerbound2) )
-            return +1;
-         else
-            return 0;
-      }
-   }
+      return 0;
 }
 
 /*
@@ -234,6 +493,19 @@ SCIP_RETCODE SCIPincludeNodeselPolicy(
          "nodeselection/"NODESEL_NAME"/polfname",
          "name of the policy model file",
          &nodeseldata->polfname, FALSE, DEFAULT_FILENAME, NULL, NULL) );
+   SCIP_CALL( SCIPaddIntParam(scip,
+         "nodeselection/"NODESEL_NAME"/beamwidth",
+         "maximum number of open nodes kept, leaves with smaller policy scores are removed (0: no beam)",
+         &nodeseldata->beamwidth, FALSE, DEFAULT_BEAMWIDTH, 0, INT_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPaddCharParam(scip,
+         "nodeselection/"NODESEL_NAME"/beammode",
+         "selection of a node in the beam ('r'ound robin: next node below the sort key of the last one served, 'd'iversity: best node whose parent is not the parent of the last selected node)",
+         &nodeseldata->beammode, FALSE, DEFAULT_BEAMMODE, "rd", NULL, NULL) );
+   SCIP_CALL( SCIPaddRealParam(scip,
+         "nodeselection/"NODESEL_NAME"/plungemargin",
+         "margin of policy score by which the best child has to beat the best leaf and sibling to be selected directly (negative: no plunging)",
+         &nodeseldata->plungemargin, FALSE, DEFAULT_PLUNGEMARGIN, -1.0, SCIP_REAL_MAX, NULL, NULL) );
+   SCIP_CALL( SCIPfeatAddOptsParams(scip, "nodeselection/"NODESEL_NAME, &nodeseldata->featopts) );
 
    return SCIP_OKAY;
 }
@@ -0,0 +1,85 @@
+/**@file   opentree.c
+ * @brief  methods on the open nodes of the branch-and-bound tree, shared by node selectors and pruners
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <assert.h>
+#include "scip/def.h"
+#include "opentree.h"
+#include "scip/tree.h"
+#include "scip/nodesel.h"
+#include "scip/struct_nodesel.h"
+#include "scip/struct_tree.h"
+#include "scip/struct_mem.h"
+#include "scip/struct_scip.h"
+
+/** remove open leaves from the tree and free them; the pruned lower bound of the tree is lowered to the bounds of the
+ *  leaves, so the global dual bound stays valid
+ *
+ *  The leaves are tagged in a hash map and taken out of the leaf queue in one pass: the remaining slots are compacted
+ *  and inserted into the emptied queue again, instead of searching the queue for each leaf.
+ */
+SCIP_RETCODE SCIPevictLeaves(
+   SCIP*              scip,
+   SCIP_NODE**        nodes,
+   int                nnodes
+   )
+{
+   SCIP_NODEPQ* nodepq;
+   SCIP_HASHMAP* evictmap;
+   SCIP_NODE** slots;
+   SCIP_NODE* node;
+   int nslots;
+   int i;
+
+   assert(scip != NULL);
+   assert(nodes != NULL || nnodes == 0);
+
+   if( nnodes == 0 )
+      return SCIP_OKAY;
+
+   nodepq = scip->tree->leaves;
+   assert(nnodes <= nodepq->len);
+
+   SCIP_CALL( SCIPhashmapCreate(&evictmap, SCIPblkmem(scip), SCIPcalcHashtableSize(2 * nnodes)) );
+   for( i = 0; i < nnodes; i++ )
+   {
+      assert(SCIPnodeGetType(nodes[i]) == SCIP_NODETYPE_LEAF);
+      SCIPdebugMessage("evicting leaf #%"SCIP_LONGINT_FORMAT"\n", SCIPnodeGetNumber(nodes[i]));
+      SCIP_CALL( SCIPhashmapInsert(evictmap, (void*)nodes[i], (void*)(size_t)1) );
+
+      /* the global dual bound must not exceed the bound of the removed subtree */
+      SCIPtreeSetPrunedLowerbound(scip->tree, scip->set, SCIPnodeGetLowerbound(nodes[i]));
+   }
+
+   /* compact the remaining slots and rebuild the queue from them; the queue keeps its size, so the insertions do not
+    * allocate memory
+    */
+   slots = nodepq->slots;
+   nslots = nodepq->len;
+   nodepq->len = 0;
+   nodepq->lowerboundsum = 0.0;
+   for( i = 0; i < nslots; i++ )
+   {
+      node = slots[i];
+      if( !SCIPhashmapExists(evictmap, (void*)node) )
+      {
+         SCIP_CALL( SCIPnodepqInsert(nodepq, scip->set, node) );
+      }
+   }
+   assert(nodepq->len == nslots - nnodes);
+   SCIPhashmapFree(&evictmap);
+
+   /* cut off the leaves only now, since cutting off changes their lower bounds */
+   for( i = 0; i < nnodes; i++ )
+   {
+      node = nodes[i];
+      SCIPnodeCutoff(node, scip->set, scip->stat, scip->tree);
+      SCIP_CALL( SCIPnodeFree(&node, scip->mem->probmem, scip->set, scip->stat, scip->eventqueue, scip->tree,
+            scip->lp) );
+   }
+
+   return SCIP_OKAY;
+}
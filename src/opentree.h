@@ -0,0 +1,32 @@
+/**@file   opentree.h
+ * @brief  internal methods on the open nodes of the branch-and-bound tree, shared by node selectors and pruners
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_OPENTREE_H__
+#define __SCIP_OPENTREE_H__
+
+#include "scip/def.h"
+#include "scip/scip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** remove open leaves from the tree and free them in one pass over the leaf queue; the pruned lower bound of the tree
+ *  is lowered to the bounds of the leaves, so the global dual bound stays valid
+ */
+extern
+SCIP_RETCODE SCIPevictLeaves(
+   SCIP*              scip,
+   SCIP_NODE**        nodes,
+   int                nnodes
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
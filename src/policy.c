@@ -5,12 +5,20 @@
 
 /*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
 
+#include <math.h>
+#include <string.h>
 #include "scip/def.h"
 #include "feat.h"
 #include "struct_feat.h"
 #include "policy.h"
+#include "policy_linear.h"
+#include "policy_gbdt.h"
+#include "policy_mlp.h"
+#include "policy_anchor.h"
+
+#define SORTKEY_DEPTHBITS      12            /**< bits of the depth in the sort key */
+#define SORTKEY_BOUNDBITS       8            /**< bits of the quantized relative lower bound in the sort key */
 
-#define HEADERSIZE_LIBSVM       6 
 
 SCIP_RETCODE SCIPpolicyCreate(
    SCIP*              scip,
@@ -21,8 +29,16 @@ SCIP_RETCODE SCIPpolicyCreate(
    assert(policy != NULL);
 
    SCIP_CALL( SCIPallocBlockMemory(scip, policy) );
-   (*policy)->weights = NULL;
-   (*policy)->size = 0;
+   (*policy)->kind = NULL;
+   (*policy)->data = NULL;
+   (*policy)->normstats = NULL;
+   (*policy)->normvals = NULL;
+   (*policy)->normsize = 0;
+   (*policy)->nnormbuckets = 0;
+   (*policy)->calibtype = 'n';
+   (*policy)->calibscores = NULL;
+   (*policy)->calibprobs = NULL;
+   (*policy)->ncalib = 0;
 
    return SCIP_OKAY;
 }
@@ -34,25 +50,113 @@ SCIP_RETCODE SCIPpolicyFree(
 {
    assert(scip != NULL);
    assert(policy != NULL);
-   assert((*policy)->weights != NULL);
 
-   BMSfreeMemoryArray(&(*policy)->weights);
+   if( (*policy)->kind != NULL )
+      (*policy)->kind->policyfree(scip, &(*policy)->data);
+   BMSfreeMemoryArrayNull(&(*policy)->normstats);
+   BMSfreeMemoryArrayNull(&(*policy)->normvals);
+   BMSfreeMemoryArrayNull(&(*policy)->calibscores);
+   BMSfreeMemoryArrayNull(&(*policy)->calibprobs);
    SCIPfreeBlockMemory(scip, policy);
 
    return SCIP_OKAY;
 }
 
-SCIP_RETCODE SCIPreadLIBSVMPolicy(
+/** read the normalization statistics following the tag "normalize": a header "<size> <nbuckets>" and, for each
+ *  bucket and feature, a line "<mean> <scale> <lower> <upper>"
+ */
+static
+SCIP_RETCODE readNormalization(
+   SCIP*              scip,
+   FILE*              file,
+   const char*        fname,
+   SCIP_POLICY*       policy
+   )
+{
+   int i;
+
+   if( fscanf(file, "%d %d", &policy->normsize, &policy->nnormbuckets) != 2 || policy->normsize <= 0
+      || policy->nnormbuckets <= 0 )
+   {
+      SCIPerrorMessage("invalid header of normalization in file <%s>\n", fname);
+      return SCIP_READERROR;
+   }
+
+   SCIP_CALL( SCIPallocMemoryArray(scip, &policy->normstats, 4 * policy->normsize * policy->nnormbuckets) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &policy->normvals, policy->normsize) );
+
+   for( i = 0; i < policy->normsize * policy->nnormbuckets; i++ )
+   {
+      SCIP_Real* stats = &policy->normstats[4 * i];
+
+      if( fscanf(file, "%"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT, &stats[0],
+            &stats[1], &stats[2], &stats[3]) != 4 || stats[2] > stats[3] )
+      {
+         SCIPerrorMessage("invalid statistics of feature %d in bucket %d in file <%s>\n", i % policy->normsize + 1,
+            i / policy->normsize, fname);
+         return SCIP_READERROR;
+      }
+   }
+
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL,
+      "normalization of %d features in %d buckets from file <%s> was read\n", policy->normsize, policy->nnormbuckets,
+      fname);
+
+   return SCIP_OKAY;
+}
+
+/** clip, center and scale the features of an example in one pass; buckets beyond the statistics use the statistics
+ *  of the last bucket
+ */
+static
+void normalizeFeats(
+   SCIP_POLICY*       policy,
+   const SCIP_Real*   featvals,
+   int                offset,
+   SCIP_Real*         normvals
+   )
+{
+   const SCIP_Real* stats;
+   int bucket;
+   int i;
+
+   bucket = MIN(offset / policy->normsize, policy->nnormbuckets - 1);
+   stats = &policy->normstats[4 * policy->normsize * bucket];
+
+   for( i = 0; i < policy->normsize; i++, stats += 4 )
+   {
+      SCIP_Real val = featvals[i];
+
+      val = val < stats[2] ? stats[2] : val;
+      val = val > stats[3] ? stats[3] : val;
+      normvals[i] = (val - stats[0]) * stats[1];
+   }
+}
+
+/** read policy (model) from file; the kind of the model is given by the first token of the file, which may be
+ *  preceded by normalization statistics of the features starting with "normalize", except for depth anchor policies
+ */
+SCIP_RETCODE SCIPreadPolicy(
    SCIP*              scip,
    char*              fname,
-   SCIP_POLICY**      policy       
+   SCIP_POLICY**      policy
    )
 {
-   int nlines = 0;
+   const SCIP_POLICYKIND* kinds[4];
+   char tag[SCIP_MAXSTRLEN];
+   FILE* file;
+   SCIP_RETCODE retcode;
    int i;
-   char buffer[SCIP_MAXSTRLEN];
 
-   FILE* file = fopen(fname, "r");
+   assert(policy != NULL);
+   assert((*policy)->kind == NULL);
+
+   kinds[0] = SCIPpolicykindLinear();
+   kinds[1] = SCIPpolicykindGBDT();
+   kinds[2] = SCIPpolicykindMLP();
+   kinds[3] = SCIPpolicykindAnchor();
+
+   file = fopen(fname, "r");
    if( file == NULL )
    {
       SCIPerrorMessage("cannot open file <%s> for reading\n", fname);
@@ -60,59 +164,350 @@ SCIP_RETCODE SCIPreadLIBSVMPolicy(
       return SCIP_NOFILE;
    }
 
-   /* find out weight vector size */
-   while( fgets(buffer, (int)sizeof(buffer), file) != NULL )
-      nlines++;
-   /* don't count libsvm model header */
-   assert(nlines >= HEADERSIZE_LIBSVM);
-   (*policy)->size = nlines - HEADERSIZE_LIBSVM;
+   if( fscanf(file, "%254s", tag) != 1 )
+      tag[0] = '\0';
+
+   if( strcmp(tag, "normalize") == 0 )
+   {
+      retcode = readNormalization(scip, file, fname, *policy);
+      if( retcode != SCIP_OKAY )
+      {
+         fclose(file);
+         return retcode;
+      }
+      if( fscanf(file, "%254s", tag) != 1 )
+         tag[0] = '\0';
+   }
+
+   for( i = 0; i < 4; i++ )
+   {
+      if( strcmp(tag, kinds[i]->tag) == 0 )
+      {
+         /* anchor policies interpolate at the raw relative depth, which the normalization would scale */
+         if( kinds[i] == SCIPpolicykindAnchor() && (*policy)->normstats != NULL )
+         {
+            SCIPerrorMessage("depth anchor policy in file <%s> cannot normalize its features\n", fname);
+            fclose(file);
+            return SCIP_READERROR;
+         }
+         (*policy)->kind = kinds[i];
+         retcode = kinds[i]->policyread(scip, file, fname, &(*policy)->data);
+         fclose(file);
+         return retcode;
+      }
+   }
    fclose(file);
-   if( (*policy)->size == 0 )
+
+   SCIPerrorMessage("unknown kind of policy <%s> in file <%s>\n", tag, fname);
+
+   return SCIP_READERROR;
+}
+
+/** check that a policy read by SCIPreadPolicy() can rank nodes, i.e., is of a kind whose score of the difference of
+ *  two nodes, on which the search policies are trained, is the difference of their scores; node selectors call this
+ *  for their policy, since the other kinds may only be used as kill policies
+ */
+SCIP_RETCODE SCIPpolicyCheckPairwise(
+   SCIP*              scip,
+   SCIP_POLICY*       policy,
+   const char*        fname
+   )
+{
+   assert(scip != NULL);
+   assert(policy != NULL);
+   assert(policy->kind != NULL);
+
+   if( !policy->kind->pairwise )
    {
-      SCIPerrorMessage("empty policy model\n");
-      return SCIP_NOFILE;
+      SCIPerrorMessage("policy <%s> of kind <%s> cannot rank nodes, since search trajectories hold differences of "
+         "nodes; use it as a kill policy\n", fname, policy->kind->tag);
+      return SCIP_READERROR;
    }
 
-   SCIP_CALL( SCIPallocMemoryArray(scip, &(*policy)->weights, (*policy)->size) );
+   return SCIP_OKAY;
+}
+
+/** check that the normalization statistics of a policy, if any, are of nodes of size features; called by the node
+ *  selectors and pruners once their feature vector is complete
+ */
+SCIP_RETCODE SCIPpolicyCheckFeatSize(
+   SCIP*              scip,
+   SCIP_POLICY*       policy,
+   int                size,
+   const char*        fname
+   )
+{
+   assert(scip != NULL);
+   assert(policy != NULL);
+
+   if( policy->normstats != NULL && policy->normsize != size )
+   {
+      SCIPerrorMessage("policy <%s> normalizes %d features per node, but nodes have %d features; check instfeats, "
+         "branchfeats and pathfeats\n", fname, policy->normsize, size);
+      return SCIP_READERROR;
+   }
+
+   return SCIP_OKAY;
+}
+
+/** read calibration of policy scores to probabilities of the positive label, either a line "platt <a> <b>" or a
+ *  line "isotonic <n>" followed by n lines "<score> <probability>" with increasing scores
+ */
+SCIP_RETCODE SCIPreadPolicyCalibration(
+   SCIP*              scip,
+   const char*        fname,
+   SCIP_POLICY*       policy
+   )
+{
+   char type[SCIP_MAXSTRLEN];
+   FILE* file;
+   int i;
+
+   assert(policy != NULL);
 
-   /* have to reopen to read weights */
    file = fopen(fname, "r");
-   /* skip header */
-   for( i = 0; i < HEADERSIZE_LIBSVM; i++ )
-      fgets(buffer, (int)sizeof(buffer), file);
-   for( i = 0; i < (*policy)->size; i++ )
-      fscanf(file, "%"SCIP_REAL_FORMAT, &((*policy)->weights[i]));
+   if( file == NULL )
+   {
+      SCIPerrorMessage("cannot open file <%s> for reading\n", fname);
+      SCIPprintSysError(fname);
+      return SCIP_NOFILE;
+   }
+
+   if( fscanf(file, "%254s", type) != 1 )
+   {
+      SCIPerrorMessage("empty calibration file <%s>\n", fname);
+      fclose(file);
+      return SCIP_READERROR;
+   }
+
+   if( strcmp(type, "platt") == 0 )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT, &policy->platta, &policy->plattb) != 2 )
+      {
+         SCIPerrorMessage("missing Platt parameters in calibration file <%s>\n", fname);
+         fclose(file);
+         return SCIP_READERROR;
+      }
+      policy->calibtype = 'p';
+   }
+   else if( strcmp(type, "isotonic") == 0 )
+   {
+      if( fscanf(file, "%d", &policy->ncalib) != 1 || policy->ncalib <= 0 )
+      {
+         SCIPerrorMessage("missing number of points in calibration file <%s>\n", fname);
+         fclose(file);
+         return SCIP_READERROR;
+      }
+      SCIP_CALL( SCIPallocMemoryArray(scip, &policy->calibscores, policy->ncalib) );
+      SCIP_CALL( SCIPallocMemoryArray(scip, &policy->calibprobs, policy->ncalib) );
+      for( i = 0; i < policy->ncalib; i++ )
+      {
+         if( fscanf(file, "%"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT, &policy->calibscores[i], &policy->calibprobs[i]) != 2
+            || (i > 0 && policy->calibscores[i] <= policy->calibscores[i-1]) )
+         {
+            SCIPerrorMessage("invalid point %d in calibration file <%s>\n", i + 1, fname);
+            fclose(file);
+            return SCIP_READERROR;
+         }
+      }
+      policy->calibtype = 'i';
+   }
+   else
+   {
+      SCIPerrorMessage("unknown calibration <%s> in file <%s>\n", type, fname);
+      fclose(file);
+      return SCIP_READERROR;
+   }
 
    fclose(file);
 
-   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL, "policy of size %d from file <%s> was %s\n",
-      (*policy)->size, fname, "read, will be used in the dagger node selector");
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL, "%s calibration from file <%s> was read\n", type, fname);
 
    return SCIP_OKAY;
 }
 
-/** calculate score of a node given its feature and the policy weight vector */
+/** returns the probability of the positive label for a score, or the score itself if the policy is not calibrated */
+SCIP_Real SCIPpolicyCalibrate(
+   SCIP_POLICY*       policy,
+   SCIP_Real          score
+   )
+{
+   int lo;
+   int hi;
+
+   assert(policy != NULL);
+
+   switch( policy->calibtype )
+   {
+   case 'p':
+      return 1.0 / (1.0 + exp(policy->platta * score + policy->plattb));
+   case 'i':
+      /* piecewise linear between the points, constant beyond them */
+      if( score <= policy->calibscores[0] )
+         return policy->calibprobs[0];
+      if( score >= policy->calibscores[policy->ncalib - 1] )
+         return policy->calibprobs[policy->ncalib - 1];
+      lo = 0;
+      hi = policy->ncalib - 1;
+      while( hi - lo > 1 )
+      {
+         int mid = (lo + hi) / 2;
+
+         if( policy->calibscores[mid] <= score )
+            lo = mid;
+         else
+            hi = mid;
+      }
+      return policy->calibprobs[lo] + (policy->calibprobs[hi] - policy->calibprobs[lo])
+         * (score - policy->calibscores[lo]) / (policy->calibscores[hi] - policy->calibscores[lo]);
+   default:
+      assert(policy->calibtype == 'n');
+      return score;
+   }
+}
+
+/** calculate score of a node given its feature and the policy */
 void SCIPcalcNodeScore(
    SCIP_NODE*         node,
    SCIP_FEAT*         feat,
    SCIP_POLICY*       policy
    )
 {
-   int offset = SCIPfeatGetOffset(feat);
-   int i;
-   SCIP_Real score = 0;
-   SCIP_Real* weights = policy->weights;
    SCIP_Real* featvals = SCIPfeatGetVals(feat);
+   SCIP_Real score;
 
-   if( (offset + SCIPfeatGetSize(feat)) > policy->size )
-      score = 0;
-   else
+   assert(policy->kind != NULL);
+
+   assert(policy->normstats == NULL || SCIPfeatGetSize(feat) == policy->normsize);
+
+   if( policy->normstats != NULL )
    {
-      for( i = 0; i < SCIPfeatGetSize(feat); i++ )
-         score += featvals[i] * weights[i+offset];
+      normalizeFeats(policy, featvals, SCIPfeatGetOffset(feat), policy->normvals);
+      featvals = policy->normvals;
    }
 
+   score = policy->kind->policyscore(policy->data, featvals, SCIPfeatGetOffset(feat), SCIPfeatGetSize(feat));
+
    SCIPnodeSetScore(node, score);
    SCIPdebugMessage("score of node  #%"SCIP_LONGINT_FORMAT": %f\n", SCIPnodeGetNumber(node), SCIPnodeGetScore(node));
 }
 
+
+/** calculate the scores of n examples of size features each, stored one after another in featvals, with the
+ *  offsets offsets; if the policy normalizes features, featvals are normalized in place
+ */
+void SCIPpolicyScoreBatch(
+   SCIP_POLICY*       policy,
+   SCIP_Real*         featvals,
+   int*               offsets,
+   int                size,
+   int                n,
+   SCIP_Real*         scores
+   )
+{
+   int k;
+
+   assert(policy->kind != NULL);
+
+   assert(policy->normstats == NULL || size == policy->normsize);
+
+   if( policy->normstats != NULL )
+   {
+      for( k = 0; k < n; k++ )
+         normalizeFeats(policy, &featvals[k * size], offsets[k], &featvals[k * size]);
+   }
+
+   if( policy->kind->policyscorebatch != NULL )
+      policy->kind->policyscorebatch(policy->data, featvals, offsets, size, n, scores);
+   else
+   {
+      for( k = 0; k < n; k++ )
+         scores[k] = policy->kind->policyscore(policy->data, &featvals[k * size], offsets[k], size);
+   }
+}
+
+/** calculate score of a node and store a sort key that orders nodes by decreasing score, decreasing depth and
+ *  increasing lower bound as its score
+ *
+ *  The key packs the score, rounded to a float and mapped to an order-preserving 32-bit integer, the depth (12 bits)
+ *  and the lower bound (8 bits) into an integer below 2^53, which is exact as a double; node selectors can thus compare
+ *  nodes by one double comparison. So that keys of nodes scored at different times agree, the lower bound is taken
+ *  relative to a reference fixed at the first key of the run: the root lower bound and the gap to the incumbent at
+ *  that time, or the absolute root lower bound (at least 1) if there is no incumbent yet.
+ */
+void SCIPcalcNodeSortKey(
+   SCIP*              scip,
+   SCIP_NODE*         node,
+   SCIP_FEAT*         feat,
+   SCIP_POLICY*       policy
+   )
+{
+   SCIP_Real score;
+   int relbound;
+   SCIP_Real relpos;
+   SCIP_Real lowerbound;
+   SCIP_Real upperbound;
+
+   SCIPcalcNodeScore(node, feat, policy);
+
+   /* fix the reference of the lower bound field */
+   if( feat->keyboundrange == 0.0 )
+   {
+      lowerbound = SCIPgetLowerboundRoot(scip);
+      upperbound = SCIPgetUpperbound(scip);
+      if( SCIPisInfinity(scip, REALABS(lowerbound)) )
+         lowerbound = 0.0;
+      feat->keylowerbound = lowerbound;
+      if( !SCIPisInfinity(scip, upperbound) && SCIPisGT(scip, upperbound, lowerbound) )
+         feat->keyboundrange = upperbound - lowerbound;
+      else
+         feat->keyboundrange = MAX(1.0, REALABS(lowerbound));
+   }
+
+   relpos = ((1 << SORTKEY_BOUNDBITS) - 1) * (SCIPnodeGetLowerbound(node) - feat->keylowerbound) / feat->keyboundrange;
+   relbound = (int)MAX(0.0, MIN(relpos, (SCIP_Real)((1 << SORTKEY_BOUNDBITS) - 1)));
+
+   score = SCIPpackSortKey(SCIPnodeGetScore(node), SCIPnodeGetDepth(node), relbound);
+   SCIPnodeSetScore(node, score);
+}
+
+/** pack a policy score, a depth and a lower bound quantized to [0,255] (0 for the smallest) into a sort key */
+SCIP_Real SCIPpackSortKey(
+   SCIP_Real          score,
+   int                depth,
+   int                relbound
+   )
+{
+   float fscore;
+   unsigned int scorebits;
+
+   assert(0 <= relbound && relbound < (1 << SORTKEY_BOUNDBITS));
+
+   /* order-preserving map of the float to an unsigned integer: flip all bits of negative numbers, the sign bit of
+    * nonnegative numbers
+    */
+   fscore = (float)score;
+   memcpy(&scorebits, &fscore, sizeof(scorebits));
+   scorebits = (scorebits & 0x80000000u) ? ~scorebits : (scorebits | 0x80000000u);
+
+   depth = MIN(depth, (1 << SORTKEY_DEPTHBITS) - 1);
+
+   /* a smaller lower bound gives a larger key */
+   return ((SCIP_Real)scorebits * (1 << SORTKEY_DEPTHBITS) + depth) * (1 << SORTKEY_BOUNDBITS)
+      + ((1 << SORTKEY_BOUNDBITS) - 1 - relbound);
+}
+
+/** returns the policy score packed in a sort key, rounded to a float */
+SCIP_Real SCIPsortKeyGetScore(
+   SCIP_Real          key
+   )
+{
+   unsigned int scorebits;
+   float score;
+
+   scorebits = (unsigned int)(key / (1 << (SORTKEY_DEPTHBITS + SORTKEY_BOUNDBITS)));
+   scorebits = (scorebits & 0x80000000u) ? (scorebits & ~0x80000000u) : ~scorebits;
+   memcpy(&score, &scorebits, sizeof(score));
+
+   return score;
+}
@@ -28,15 +28,59 @@ SCIP_RETCODE SCIPpolicyFree(
    SCIP_POLICY**      policy
    );
 
-/** read policy (model) in LIBSVM format */
+/** read policy (model) from file; the kind of the model is given by the first token of the file: "solver_type" for
+ *  LIBLINEAR models (see policy_linear.h), "gbdt" for tree ensembles (see policy_gbdt.h), "mlp" for perceptrons
+ *  (see policy_mlp.h) and "anchor" for depth anchor policies (see policy_anchor.h)
+ *
+ *  The model may be preceded by normalization statistics "normalize <size> <nbuckets>" followed by a line
+ *  "<mean> <scale> <lower> <upper>" for each bucket and feature; the features of an example in bucket b are then
+ *  clipped to [lower, upper], centered at mean and multiplied by scale before the model scores them. Depth anchor
+ *  policies reject normalization, since their anchors are values of the raw relative depth.
+ */
 extern
-SCIP_RETCODE SCIPreadLIBSVMPolicy(
+SCIP_RETCODE SCIPreadPolicy(
    SCIP*              scip,
    char*              fname,
    SCIP_POLICY**      policy
    );
 
-/** calculate score of a node given its feature and the policy weight vector */
+/** check that a policy read by SCIPreadPolicy() can rank nodes, i.e., is of a kind whose score of the difference of
+ *  two nodes, on which the search policies are trained, is the difference of their scores
+ */
+extern
+SCIP_RETCODE SCIPpolicyCheckPairwise(
+   SCIP*              scip,
+   SCIP_POLICY*       policy,
+   const char*        fname
+   );
+
+/** check that the normalization statistics of a policy, if any, are of nodes of size features */
+extern
+SCIP_RETCODE SCIPpolicyCheckFeatSize(
+   SCIP*              scip,
+   SCIP_POLICY*       policy,
+   int                size,
+   const char*        fname
+   );
+
+/** read calibration of policy scores to probabilities of the positive label, either a line "platt <a> <b>" or a
+ *  line "isotonic <n>" followed by n lines "<score> <probability>" with increasing scores
+ */
+extern
+SCIP_RETCODE SCIPreadPolicyCalibration(
+   SCIP*              scip,
+   const char*        fname,
+   SCIP_POLICY*       policy
+   );
+
+/** returns the probability of the positive label for a score, or the score itself if the policy is not calibrated */
+extern
+SCIP_Real SCIPpolicyCalibrate(
+   SCIP_POLICY*       policy,
+   SCIP_Real          score
+   );
+
+/** calculate score of a node given its feature and the policy */
 extern
 void SCIPcalcNodeScore(
    SCIP_NODE*         node,
@@ -44,6 +88,44 @@ void SCIPcalcNodeScore(
    SCIP_POLICY*       policy
    );
 
+/** calculate the scores of n examples of size features each, stored one after another in featvals, with the
+ *  offsets offsets; if the policy normalizes features, featvals are normalized in place
+ */
+extern
+void SCIPpolicyScoreBatch(
+   SCIP_POLICY*       policy,
+   SCIP_Real*         featvals,
+   int*               offsets,
+   int                size,
+   int                n,
+   SCIP_Real*         scores
+   );
+
+/** calculate score of a node and store a sort key that orders nodes by decreasing score, decreasing depth and
+ *  increasing lower bound as its score
+ */
+extern
+void SCIPcalcNodeSortKey(
+   SCIP*              scip,
+   SCIP_NODE*         node,
+   SCIP_FEAT*         feat,
+   SCIP_POLICY*       policy
+   );
+
+/** pack a policy score, a depth and a lower bound quantized to [0,255] (0 for the smallest) into a sort key */
+extern
+SCIP_Real SCIPpackSortKey(
+   SCIP_Real          score,
+   int                depth,
+   int                relbound
+   );
+
+/** returns the policy score packed in a sort key, rounded to a float */
+extern
+SCIP_Real SCIPsortKeyGetScore(
+   SCIP_Real          key
+   );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,159 @@
+/**@file   policy_anchor.c
+ * @brief  linear policies whose weights are interpolated between depth anchors
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <assert.h>
+#include "scip/scip.h"
+#include "policy_anchor.h"
+
+#define POLICY_TAG              "anchor"
+
+/** anchor weights in low rank */
+struct SCIP_PolicyData
+{
+   SCIP_Real*     anchors;            /**< increasing values of the relative depth feature */
+   SCIP_Real*     basis;              /**< rank basis vectors of size features each */
+   SCIP_Real*     coefs;              /**< rank coefficients of each anchor and direction, anchor major */
+   int            size;               /**< number of features of a node */
+   int            depthfeature;       /**< index of the relative depth among the features (starting at 0) */
+   int            nanchors;           /**< number of anchors */
+   int            rank;               /**< number of basis vectors */
+};
+
+/** reads the anchors following the type tag */
+static
+SCIP_DECL_POLICYREAD(policyReadAnchor)
+{
+   SCIP_POLICYDATA* data;
+   int i;
+
+   SCIP_CALL( SCIPallocMemory(scip, policydata) );
+   data = *policydata;
+   data->anchors = NULL;
+   data->basis = NULL;
+   data->coefs = NULL;
+
+   if( fscanf(file, "%d %d %d %d", &data->size, &data->depthfeature, &data->nanchors, &data->rank) != 4
+      || data->size <= 0 || data->depthfeature < 1 || data->depthfeature > data->size || data->nanchors <= 0
+      || data->rank <= 0 )
+   {
+      SCIPerrorMessage("invalid header of depth anchor policy in file <%s>\n", fname);
+      return SCIP_READERROR;
+   }
+   data->depthfeature--;
+
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->anchors, data->nanchors) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->basis, data->rank * data->size) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->coefs, 2 * data->nanchors * data->rank) );
+
+   for( i = 0; i < data->nanchors; i++ )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT, &data->anchors[i]) != 1
+         || (i > 0 && data->anchors[i] <= data->anchors[i-1]) )
+      {
+         SCIPerrorMessage("invalid anchor %d in file <%s>\n", i + 1, fname);
+         return SCIP_READERROR;
+      }
+   }
+   for( i = 0; i < data->rank * data->size; i++ )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT, &data->basis[i]) != 1 )
+      {
+         SCIPerrorMessage("missing entry %d of basis vector %d in file <%s>\n", i % data->size + 1, i / data->size + 1,
+            fname);
+         return SCIP_READERROR;
+      }
+   }
+   for( i = 0; i < 2 * data->nanchors * data->rank; i++ )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT, &data->coefs[i]) != 1 )
+      {
+         SCIPerrorMessage("missing coefficient %d of anchor %d in file <%s>\n", i % data->rank + 1,
+            i / (2 * data->rank) + 1, fname);
+         return SCIP_READERROR;
+      }
+   }
+
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL,
+      "policy of %d depth anchors of rank %d and size %d from file <%s> was read\n", data->nanchors, data->rank,
+      data->size, fname);
+
+   return SCIP_OKAY;
+}
+
+/** dot product of the example with the weights interpolated at its relative depth; examples of another size are
+ *  scored 0
+ */
+static
+SCIP_DECL_POLICYSCORE(policyScoreAnchor)
+{
+   const SCIP_Real* lo;
+   const SCIP_Real* hi;
+   SCIP_Real depth;
+   SCIP_Real t;
+   SCIP_Real score;
+   int dir;
+   int k;
+   int i;
+   int j;
+
+   if( size != policydata->size )
+      return 0.0;
+
+   /* the two anchors around the depth and the interpolation factor between them */
+   depth = featvals[policydata->depthfeature];
+   k = 0;
+   while( k < policydata->nanchors - 1 && policydata->anchors[k + 1] <= depth )
+      k++;
+   if( k == policydata->nanchors - 1 || depth <= policydata->anchors[k] )
+      t = 0.0;
+   else
+      t = (depth - policydata->anchors[k]) / (policydata->anchors[k + 1] - policydata->anchors[k]);
+
+   dir = (offset / size) % 2;
+   lo = &policydata->coefs[(2 * k + dir) * policydata->rank];
+   hi = t > 0.0 ? &policydata->coefs[(2 * (k + 1) + dir) * policydata->rank] : lo;
+
+   score = 0.0;
+   for( j = 0; j < policydata->rank; j++ )
+   {
+      const SCIP_Real* basis = &policydata->basis[j * size];
+      SCIP_Real proj = 0.0;
+
+      for( i = 0; i < size; i++ )
+         proj += basis[i] * featvals[i];
+      score += ((1.0 - t) * lo[j] + t * hi[j]) * proj;
+   }
+
+   return score;
+}
+
+/** frees the anchors */
+static
+SCIP_DECL_POLICYFREE(policyFreeAnchor)
+{
+   assert(policydata != NULL);
+
+   if( *policydata == NULL )
+      return;
+
+   BMSfreeMemoryArrayNull(&(*policydata)->anchors);
+   BMSfreeMemoryArrayNull(&(*policydata)->basis);
+   BMSfreeMemoryArrayNull(&(*policydata)->coefs);
+   BMSfreeMemory(policydata);
+}
+
+static const SCIP_POLICYKIND policykind = {
+   POLICY_TAG, TRUE, policyReadAnchor, policyScoreAnchor, NULL, policyFreeAnchor
+};
+
+/** returns the kind of depth anchor policies */
+const SCIP_POLICYKIND* SCIPpolicykindAnchor(
+   void
+   )
+{
+   return &policykind;
+}
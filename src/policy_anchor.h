@@ -0,0 +1,38 @@
+/**@file   policy_anchor.h
+ * @brief  linear policies whose weights are interpolated between depth anchors
+ * @author He He
+ *
+ * Instead of one weight vector per depth decile and branching direction, the weights are given at a few anchors of
+ * the relative depth feature and interpolated linearly between them; beyond the first and the last anchor they are
+ * constant. The anchor weights are stored in low rank: the weight vector of anchor k and direction b is
+ * sum_j coef[k][b][j] * basis[j], so scoring takes rank dot products with the features.
+ *
+ * The policy file starts with a header "anchor <size> <depthfeature> <nanchors> <rank>", where size is the number of
+ * features of a node and depthfeature the index (starting at 1) of the relative depth among them. It is followed by a
+ * line with the increasing anchors, rank lines with the basis vectors, and 2 * nanchors lines with the coefficients of
+ * the anchors, for the downwards and the upwards branch of each anchor. The direction of a node is taken from its
+ * feature offset.
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_POLICY_ANCHOR_H__
+#define __SCIP_POLICY_ANCHOR_H__
+
+#include "struct_policy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** returns the kind of depth anchor policies */
+extern
+const SCIP_POLICYKIND* SCIPpolicykindAnchor(
+   void
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
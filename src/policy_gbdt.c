@@ -0,0 +1,191 @@
+/**@file   policy_gbdt.c
+ * @brief  policies given by ensembles of gradient-boosted regression trees
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <assert.h>
+#include "scip/scip.h"
+#include "policy_gbdt.h"
+
+#define POLICY_TAG              "gbdt"
+
+/** internal node of a regression tree; a child >= 0 is an internal node, a child < 0 is the leaf -child-1 */
+struct SCIP_GbdtNode
+{
+   int            feature;            /**< index of the split feature in the example (starting at 1) */
+   float          threshold;          /**< examples whose feature is less than the threshold go to children[0] */
+   int            children[3];        /**< child for values below, at or above the threshold, and missing values */
+};
+typedef struct SCIP_GbdtNode SCIP_GBDTNODE;
+
+/** tree ensemble whose internal nodes of all trees are kept in one array */
+struct SCIP_PolicyData
+{
+   SCIP_GBDTNODE* nodes;              /**< internal nodes of all trees */
+   SCIP_Real*     leaves;             /**< leaf values of all trees */
+   int*           roots;              /**< root of each tree, as a child index */
+   int            ntrees;             /**< number of trees */
+   int            nnodes;             /**< number of internal nodes */
+   int            nleaves;            /**< number of leaves */
+   SCIP_Real      base;               /**< score added to the sum of the trees */
+};
+
+/** returns the leaf of a tree reached by an example */
+static
+int gbdtGetLeaf(
+   SCIP_POLICYDATA*   policydata,
+   int                root,
+   SCIP_Real*         featvals,
+   int                offset,
+   int                size
+   )
+{
+   const SCIP_GBDTNODE* nodes = policydata->nodes;
+   int child = root;
+
+   /* descend by indexing the children with the comparison instead of branching on it */
+   while( child >= 0 )
+   {
+      const SCIP_GBDTNODE* node = &nodes[child];
+      unsigned int j = (unsigned int)(node->feature - 1 - offset);
+
+      if( j < (unsigned int)size )
+         child = node->children[featvals[j] >= node->threshold];
+      else
+         child = node->children[2];
+   }
+
+   return -child - 1;
+}
+
+/** reads the trees following the type tag */
+static
+SCIP_DECL_POLICYREAD(policyReadGBDT)
+{
+   SCIP_POLICYDATA* data;
+   int i;
+   int j;
+
+   SCIP_CALL( SCIPallocMemory(scip, policydata) );
+   data = *policydata;
+   data->nodes = NULL;
+   data->leaves = NULL;
+   data->roots = NULL;
+
+   if( fscanf(file, "%d %d %d %"SCIP_REAL_FORMAT, &data->ntrees, &data->nnodes, &data->nleaves, &data->base) != 4
+      || data->ntrees <= 0 || data->nnodes < 0 || data->nleaves <= 0 )
+   {
+      SCIPerrorMessage("invalid header of tree ensemble in file <%s>\n", fname);
+      return SCIP_READERROR;
+   }
+
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->roots, data->ntrees) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->nodes, MAX(data->nnodes, 1)) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->leaves, data->nleaves) );
+
+   for( i = 0; i < data->ntrees; i++ )
+   {
+      if( fscanf(file, "%d", &data->roots[i]) != 1 || data->roots[i] >= data->nnodes
+         || -data->roots[i] - 1 >= data->nleaves )
+      {
+         SCIPerrorMessage("invalid root of tree %d in file <%s>\n", i + 1, fname);
+         return SCIP_READERROR;
+      }
+   }
+   for( i = 0; i < data->nnodes; i++ )
+   {
+      SCIP_GBDTNODE* node = &data->nodes[i];
+
+      if( fscanf(file, "%d %f %d %d %d", &node->feature, &node->threshold, &node->children[0], &node->children[1],
+            &node->children[2]) != 5 || node->feature < 1 )
+      {
+         SCIPerrorMessage("invalid node %d in file <%s>\n", i + 1, fname);
+         return SCIP_READERROR;
+      }
+      for( j = 0; j < 3; j++ )
+      {
+         /* children follow their parent, so every path ends in a leaf */
+         if( node->children[j] >= data->nnodes || (node->children[j] >= 0 && node->children[j] <= i)
+            || -node->children[j] - 1 >= data->nleaves )
+         {
+            SCIPerrorMessage("invalid child of node %d in file <%s>\n", i + 1, fname);
+            return SCIP_READERROR;
+         }
+      }
+   }
+   for( i = 0; i < data->nleaves; i++ )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT, &data->leaves[i]) != 1 )
+      {
+         SCIPerrorMessage("missing value of leaf %d in file <%s>\n", i + 1, fname);
+         return SCIP_READERROR;
+      }
+   }
+
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL, "policy of %d trees with %d nodes from file <%s> was read\n",
+      data->ntrees, data->nnodes, fname);
+
+   return SCIP_OKAY;
+}
+
+/** sum of the trees on the example */
+static
+SCIP_DECL_POLICYSCORE(policyScoreGBDT)
+{
+   SCIP_Real score = policydata->base;
+   int t;
+
+   for( t = 0; t < policydata->ntrees; t++ )
+      score += policydata->leaves[gbdtGetLeaf(policydata, policydata->roots[t], featvals, offset, size)];
+
+   return score;
+}
+
+/** sums of the trees on the examples; all examples pass through one tree before the next, which keeps the nodes of a
+ *  tree in cache
+ */
+static
+SCIP_DECL_POLICYSCOREBATCH(policyScoreBatchGBDT)
+{
+   int t;
+   int k;
+
+   for( k = 0; k < n; k++ )
+      scores[k] = policydata->base;
+
+   for( t = 0; t < policydata->ntrees; t++ )
+   {
+      for( k = 0; k < n; k++ )
+         scores[k] += policydata->leaves[gbdtGetLeaf(policydata, policydata->roots[t], &featvals[k * size], offsets[k],
+               size)];
+   }
+}
+
+/** frees the trees */
+static
+SCIP_DECL_POLICYFREE(policyFreeGBDT)
+{
+   assert(policydata != NULL);
+
+   if( *policydata == NULL )
+      return;
+
+   BMSfreeMemoryArrayNull(&(*policydata)->nodes);
+   BMSfreeMemoryArrayNull(&(*policydata)->leaves);
+   BMSfreeMemoryArrayNull(&(*policydata)->roots);
+   BMSfreeMemory(policydata);
+}
+
+static const SCIP_POLICYKIND policykind = {
+   POLICY_TAG, FALSE, policyReadGBDT, policyScoreGBDT, policyScoreBatchGBDT, policyFreeGBDT
+};
+
+/** returns the kind of tree ensemble policies */
+const SCIP_POLICYKIND* SCIPpolicykindGBDT(
+   void
+   )
+{
+   return &policykind;
+}
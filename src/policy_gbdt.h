@@ -0,0 +1,32 @@
+/**@file   policy_gbdt.h
+ * @brief  policies given by ensembles of gradient-boosted regression trees
+ * @author He He
+ *
+ * The policy file starts with a header "gbdt <ntrees> <nnodes> <nleaves> <base>", followed by one line per tree with
+ * its root, one line per internal node "<feature> <threshold> <below> <above> <missing>" and one line per leaf with its
+ * value; children >= 0 are internal nodes, which follow their parent, and children < 0 are the leaves -child-1. The
+ * score of an example is base plus the sum of its leaves; features outside the example are missing.
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_POLICY_GBDT_H__
+#define __SCIP_POLICY_GBDT_H__
+
+#include "struct_policy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** returns the kind of tree ensemble policies */
+extern
+const SCIP_POLICYKIND* SCIPpolicykindGBDT(
+   void
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
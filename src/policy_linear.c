@@ -0,0 +1,114 @@
+/**@file   policy_linear.c
+ * @brief  linear policies trained by LIBLINEAR
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <assert.h>
+#include "scip/scip.h"
+#include "policy_linear.h"
+
+#define POLICY_TAG              "solver_type"
+#define HEADERSIZE_LIBSVM       6
+
+/** linear model */
+struct SCIP_PolicyData
+{
+   SCIP_Real*     weights;
+   int            size;
+};
+
+/** reads the weights following the header of a LIBLINEAR model */
+static
+SCIP_DECL_POLICYREAD(policyReadLinear)
+{
+   char buffer[SCIP_MAXSTRLEN];
+   SCIP_Real weight;
+   int nweights;
+   int i;
+
+   SCIP_CALL( SCIPallocMemory(scip, policydata) );
+   (*policydata)->size = 0;
+   nweights = 64;
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*policydata)->weights, nweights) );
+
+   /* skip the rest of the first line and the rest of the header */
+   for( i = 0; i < HEADERSIZE_LIBSVM; i++ )
+   {
+      if( fgets(buffer, (int)sizeof(buffer), file) == NULL )
+         break;
+   }
+
+   while( fscanf(file, "%"SCIP_REAL_FORMAT, &weight) == 1 )
+   {
+      if( (*policydata)->size == nweights )
+      {
+         nweights *= 2;
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &(*policydata)->weights, nweights) );
+      }
+      (*policydata)->weights[(*policydata)->size++] = weight;
+   }
+   if( (*policydata)->size == 0 )
+   {
+      SCIPerrorMessage("empty policy model\n");
+      return SCIP_NOFILE;
+   }
+
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL, "policy of size %d from file <%s> was %s\n",
+      (*policydata)->size, fname, "read, will be used in the dagger node selector");
+
+   return SCIP_OKAY;
+}
+
+/** dot product of the example with the weights at its indices */
+static
+SCIP_DECL_POLICYSCORE(policyScoreLinear)
+{
+   SCIP_Real* weights = policydata->weights;
+   SCIP_Real score = 0;
+   int i;
+
+   if( (offset + size) > policydata->size )
+      return 0;
+
+   for( i = 0; i < size; i++ )
+      score += featvals[i] * weights[i+offset];
+
+   return score;
+}
+
+/** dot products of the examples with the weights */
+static
+SCIP_DECL_POLICYSCOREBATCH(policyScoreBatchLinear)
+{
+   int k;
+
+   for( k = 0; k < n; k++ )
+      scores[k] = policyScoreLinear(policydata, &featvals[k * size], offsets[k], size);
+}
+
+/** frees the weights */
+static
+SCIP_DECL_POLICYFREE(policyFreeLinear)
+{
+   assert(policydata != NULL);
+
+   if( *policydata == NULL )
+      return;
+
+   BMSfreeMemoryArrayNull(&(*policydata)->weights);
+   BMSfreeMemory(policydata);
+}
+
+static const SCIP_POLICYKIND policykind = {
+   POLICY_TAG, TRUE, policyReadLinear, policyScoreLinear, policyScoreBatchLinear, policyFreeLinear
+};
+
+/** returns the kind of linear policies */
+const SCIP_POLICYKIND* SCIPpolicykindLinear(
+   void
+   )
+{
+   return &policykind;
+}
@@ -0,0 +1,31 @@
+/**@file   policy_linear.h
+ * @brief  linear policies trained by LIBLINEAR
+ * @author He He
+ *
+ * The policy file is a LIBLINEAR model: six header lines, the first of which starts with "solver_type", followed by
+ * one weight per line. The score of an example is the dot product of its features with the weights at its LIBSVM
+ * indices; examples beyond the weight vector are scored 0.
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_POLICY_LINEAR_H__
+#define __SCIP_POLICY_LINEAR_H__
+
+#include "struct_policy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** returns the kind of linear policies */
+extern
+const SCIP_POLICYKIND* SCIPpolicykindLinear(
+   void
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,223 @@
+/**@file   policy_mlp.c
+ * @brief  policies given by perceptrons with 8 bit integer weights
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <assert.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "scip/scip.h"
+#include "policy_mlp.h"
+
+#define POLICY_TAG              "mlp"
+
+#define MLP_BLOCKSIZE          16            /**< number of 8 bit inputs processed by one step of the dot product */
+
+/** perceptron with one hidden layer of rectified linear units whose input and hidden weights are quantized to 8 bit
+ *  integers
+ */
+struct SCIP_PolicyData
+{
+   int            nin;                /**< number of inputs, i.e., features of a node */
+   int            npad;               /**< number of inputs padded to a multiple of MLP_BLOCKSIZE */
+   int            nhidden;            /**< number of hidden units */
+   SCIP_Real*     inscale;            /**< factors quantizing the inputs to [-127,127] */
+   signed char*   weights;            /**< quantized weights of the hidden units, npad per unit */
+   SCIP_Real*     scale;              /**< factors of the hidden units turning quantized dot products into reals */
+   SCIP_Real*     bias;               /**< biases of the hidden units */
+   SCIP_Real*     out;                /**< weights of the hidden units in the output */
+   SCIP_Real      outbias;            /**< bias of the output */
+   signed char*   input;              /**< buffer of the quantized inputs, padded with zeros */
+};
+
+/** dot product of two vectors of 8 bit integers whose length is a multiple of MLP_BLOCKSIZE; the products are widened
+ *  to 16 bit and summed pairwise to 32 bit, with AVX2 or SSE2 if the compiler targets them
+ */
+static
+int mlpDot(
+   const signed char* a,
+   const signed char* b,
+   int                n
+   )
+{
+   int i;
+#if defined(__AVX2__)
+   __m256i acc = _mm256_setzero_si256();
+   __m128i sum;
+
+   for( i = 0; i < n; i += MLP_BLOCKSIZE )
+   {
+      __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a + i)));
+      __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b + i)));
+
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+   }
+   sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+
+   return _mm_cvtsi128_si32(sum);
+#elif defined(__SSE2__)
+   __m128i acc = _mm_setzero_si128();
+
+   for( i = 0; i < n; i += MLP_BLOCKSIZE )
+   {
+      __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+      __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+
+      /* sign extend by unpacking each byte into the high byte of a 16 bit word and shifting it down */
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8),
+            _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8)));
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8),
+            _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8)));
+   }
+   acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+   acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+
+   return _mm_cvtsi128_si32(acc);
+#else
+   int sum = 0;
+
+   for( i = 0; i < n; i++ )
+      sum += (int)a[i] * (int)b[i];
+
+   return sum;
+#endif
+}
+
+
+/** output of the perceptron on the example; examples with another number of features are scored 0 */
+static
+SCIP_DECL_POLICYSCORE(policyScoreMLP)
+{
+   signed char* input = policydata->input;
+   SCIP_Real score = policydata->outbias;
+   int i;
+   int h;
+
+   if( size != policydata->nin )
+      return 0.0;
+
+   for( i = 0; i < size; i++ )
+   {
+      SCIP_Real val = featvals[i] * policydata->inscale[i];
+
+      val = MAX(val, -127.0);
+      val = MIN(val, 127.0);
+      input[i] = (signed char)(val < 0.0 ? val - 0.5 : val + 0.5);
+   }
+
+   for( h = 0; h < policydata->nhidden; h++ )
+   {
+      SCIP_Real act = policydata->scale[h] * mlpDot(&policydata->weights[h * policydata->npad], input,
+            policydata->npad) + policydata->bias[h];
+
+      if( act > 0.0 )
+         score += policydata->out[h] * act;
+   }
+
+   return score;
+}
+
+/** reads a quantized perceptron following the type tag */
+static
+SCIP_DECL_POLICYREAD(policyReadMLP)
+{
+   SCIP_POLICYDATA* data;
+   int weight;
+   int i;
+   int h;
+
+   SCIP_CALL( SCIPallocMemory(scip, policydata) );
+   data = *policydata;
+   data->inscale = NULL;
+   data->weights = NULL;
+   data->scale = NULL;
+   data->bias = NULL;
+   data->out = NULL;
+   data->input = NULL;
+
+   if( fscanf(file, "%d %d %"SCIP_REAL_FORMAT, &data->nin, &data->nhidden, &data->outbias) != 3
+      || data->nin <= 0 || data->nhidden <= 0 )
+   {
+      SCIPerrorMessage("invalid header of perceptron in file <%s>\n", fname);
+      return SCIP_READERROR;
+   }
+
+   data->npad = ((data->nin + MLP_BLOCKSIZE - 1) / MLP_BLOCKSIZE) * MLP_BLOCKSIZE;
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->inscale, data->nin) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->weights, data->nhidden * data->npad) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->scale, data->nhidden) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->bias, data->nhidden) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->out, data->nhidden) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &data->input, data->npad) );
+   BMSclearMemoryArray(data->weights, data->nhidden * data->npad);
+   BMSclearMemoryArray(data->input, data->npad);
+
+   for( i = 0; i < data->nin; i++ )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT, &data->inscale[i]) != 1 )
+      {
+         SCIPerrorMessage("missing input factor %d in file <%s>\n", i + 1, fname);
+         return SCIP_READERROR;
+      }
+   }
+   for( h = 0; h < data->nhidden; h++ )
+   {
+      if( fscanf(file, "%"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT" %"SCIP_REAL_FORMAT, &data->scale[h],
+            &data->bias[h], &data->out[h]) != 3 )
+      {
+         SCIPerrorMessage("invalid hidden unit %d in file <%s>\n", h + 1, fname);
+         return SCIP_READERROR;
+      }
+      for( i = 0; i < data->nin; i++ )
+      {
+         if( fscanf(file, "%d", &weight) != 1 || weight < -127 || weight > 127 )
+         {
+            SCIPerrorMessage("invalid weight %d of hidden unit %d in file <%s>\n", i + 1, h + 1, fname);
+            return SCIP_READERROR;
+         }
+         data->weights[h * data->npad + i] = (signed char)weight;
+      }
+   }
+
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL,
+      "policy of %d inputs and %d hidden units from file <%s> was read\n", data->nin, data->nhidden, fname);
+
+   return SCIP_OKAY;
+}
+
+/** frees the perceptron */
+static
+SCIP_DECL_POLICYFREE(policyFreeMLP)
+{
+   assert(policydata != NULL);
+
+   if( *policydata == NULL )
+      return;
+
+   BMSfreeMemoryArrayNull(&(*policydata)->inscale);
+   BMSfreeMemoryArrayNull(&(*policydata)->weights);
+   BMSfreeMemoryArrayNull(&(*policydata)->scale);
+   BMSfreeMemoryArrayNull(&(*policydata)->bias);
+   BMSfreeMemoryArrayNull(&(*policydata)->out);
+   BMSfreeMemoryArrayNull(&(*policydata)->input);
+   BMSfreeMemory(policydata);
+}
+
+static const SCIP_POLICYKIND policykind = {
+   POLICY_TAG, FALSE, policyReadMLP, policyScoreMLP, NULL, policyFreeMLP
+};
+
+/** returns the kind of perceptron policies */
+const SCIP_POLICYKIND* SCIPpolicykindMLP(
+   void
+   )
+{
+   return &policykind;
+}
@@ -0,0 +1,34 @@
+/**@file   policy_mlp.h
+ * @brief  policies given by perceptrons with 8 bit integer weights
+ * @author He He
+ *
+ * The policy file starts with a header "mlp <ninputs> <nhidden> <outputbias>", followed by a line with the factors
+ * quantizing each input and one line per hidden unit "<scale> <bias> <outputweight> <w_1> ... <w_ninputs>" with
+ * integer weights in [-127,127]. A hidden unit outputs max(0, scale * sum_i w_i * round(factor_i * x_i) + bias), the
+ * score of an example is outputbias plus the weighted sum of the hidden units. The inputs are the features of a node,
+ * regardless of their offset. Perceptrons are not linear, so they can only be kill policies (see
+ * SCIPpolicyCheckPairwise()); bin/benchdagger --policy <file> --budget <ns> checks their latency.
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_POLICY_MLP_H__
+#define __SCIP_POLICY_MLP_H__
+
+#include "struct_policy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** returns the kind of perceptron policies */
+extern
+const SCIP_POLICYKIND* SCIPpolicykindMLP(
+   void
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+/**@file   polindex.c
+ * @brief  selection of the policies of an instance from a policy directory by the fingerprint of the instance
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "polindex.h"
+
+/** calculate the fingerprint of the problem; must be called after the problem was read and before it is solved */
+SCIP_RETCODE SCIPcalcFingerprint(
+   SCIP*              scip,
+   SCIP_Real*         fingerprint
+   )
+{
+   assert(scip != NULL);
+   assert(fingerprint != NULL);
+   assert(SCIPgetStage(scip) == SCIP_STAGE_PROBLEM);
+
+   SCIP_CALL( SCIPcalcProblemStats(scip, fingerprint) );
+
+   return SCIP_OKAY;
+}
+
+/** parse a line of the index into the policy names and the fingerprint; *isentry is set to FALSE for empty lines and
+ *  comments
+ */
+static
+SCIP_RETCODE polindexParseLine(
+   const char*        line,
+   int                lineno,
+   const char*        fname,
+   char*              selname,
+   char*              pruname,
+   SCIP_Real*         vals,
+   SCIP_Bool*         isentry
+   )
+{
+   const char* pos;
+   int len;
+   int i;
+
+   *isentry = FALSE;
+   if( sscanf(line, "%s", selname) != 1 || selname[0] == '#' )
+      return SCIP_OKAY;
+   if( sscanf(line, "%s %s%n", selname, pruname, &len) != 2 )
+   {
+      SCIPerrorMessage("missing kill policy in line %d of file <%s>\n", lineno, fname);
+      return SCIP_READERROR;
+   }
+
+   pos = &line[len];
+   for( i = 0; i < SCIP_FINGERPRINT_SIZE; i++ )
+   {
+      char* end;
+
+      vals[i] = strtod(pos, &end);
+      if( end == pos )
+      {
+         SCIPerrorMessage("missing fingerprint entry %d in line %d of file <%s>\n", i + 1, lineno, fname);
+         return SCIP_READERROR;
+      }
+      pos = end;
+   }
+   *isentry = TRUE;
+
+   return SCIP_OKAY;
+}
+
+/** copy the policy file name of an index entry, relative to the policy directory, to polfname */
+static
+void polindexSetPolicy(
+   const char*        poldir,
+   const char*        name,
+   char*              polfname
+   )
+{
+   if( strcmp(name, "-") == 0 )
+      polfname[0] = '\0';
+   else if( name[0] == '/' )
+      (void) SCIPsnprintf(polfname, SCIP_MAXSTRLEN, "%s", name);
+   else
+      (void) SCIPsnprintf(polfname, SCIP_MAXSTRLEN, "%s/%s", poldir, name);
+}
+
+/** select the entry of the index of the policy directory nearest to the fingerprint; the policy file names are written
+ *  to nodeselpol and nodeprupol (size SCIP_MAXSTRLEN), or set to the empty string if the entry has none
+ */
+SCIP_RETCODE SCIPpolindexSelect(
+   SCIP*              scip,
+   const char*        poldir,
+   const SCIP_Real*   fingerprint,
+   char*              nodeselpol,
+   char*              nodeprupol
+   )
+{
+   char fname[SCIP_MAXSTRLEN];
+   char line[SCIP_MAXSTRLEN];
+   char selname[SCIP_MAXSTRLEN];
+   char pruname[SCIP_MAXSTRLEN];
+   SCIP_Real vals[SCIP_FINGERPRINT_SIZE];
+   SCIP_Real mean[SCIP_FINGERPRINT_SIZE];
+   SCIP_Real scale[SCIP_FINGERPRINT_SIZE];
+   SCIP_Real bestdist;
+   SCIP_Bool isentry;
+   SCIP_RETCODE retcode;
+   FILE* file;
+   int lineno;
+   int nentries;
+   int bestline;
+   int i;
+
+   assert(scip != NULL);
+   assert(poldir != NULL);
+   assert(fingerprint != NULL);
+   assert(nodeselpol != NULL);
+   assert(nodeprupol != NULL);
+
+   (void) SCIPsnprintf(fname, SCIP_MAXSTRLEN, "%s/%s", poldir, SCIP_POLINDEX_FNAME);
+   file = fopen(fname, "r");
+   if( file == NULL )
+   {
+      SCIPerrorMessage("cannot open file <%s> for reading\n", fname);
+      SCIPprintSysError(fname);
+      return SCIP_NOFILE;
+   }
+
+   /* first pass: standard deviation of each fingerprint entry over the index entries (Welford's method) */
+   for( i = 0; i < SCIP_FINGERPRINT_SIZE; i++ )
+   {
+      mean[i] = 0.0;
+      scale[i] = 0.0;
+   }
+   nentries = 0;
+   lineno = 0;
+   while( fgets(line, (int)sizeof(line), file) != NULL )
+   {
+      lineno++;
+      retcode = polindexParseLine(line, lineno, fname, selname, pruname, vals, &isentry);
+      if( retcode != SCIP_OKAY )
+      {
+         fclose(file);
+         return retcode;
+      }
+      if( !isentry )
+         continue;
+
+      nentries++;
+      for( i = 0; i < SCIP_FINGERPRINT_SIZE; i++ )
+      {
+         SCIP_Real delta = vals[i] - mean[i];
+
+         mean[i] += delta / nentries;
+         scale[i] += delta * (vals[i] - mean[i]);
+      }
+   }
+
+   if( nentries == 0 )
+   {
+      fclose(file);
+      SCIPerrorMessage("no policies in file <%s>\n", fname);
+      return SCIP_READERROR;
+   }
+
+   /* entries that do not vary over the index do not tell the datasets apart and get weight 0 */
+   for( i = 0; i < SCIP_FINGERPRINT_SIZE; i++ )
+   {
+      SCIP_Real sdev = sqrt(scale[i] / nentries);
+
+      scale[i] = SCIPisZero(scip, sdev) ? 0.0 : 1.0 / sdev;
+   }
+
+   /* second pass: the entry of least standardized distance */
+   rewind(file);
+   bestdist = SCIPinfinity(scip);
+   bestline = 0;
+   lineno = 0;
+   while( fgets(line, (int)sizeof(line), file) != NULL )
+   {
+      SCIP_Real dist;
+
+      lineno++;
+      retcode = polindexParseLine(line, lineno, fname, selname, pruname, vals, &isentry);
+      if( retcode != SCIP_OKAY )
+      {
+         fclose(file);
+         return retcode;
+      }
+      if( !isentry )
+         continue;
+
+      /* squared standardized distance of the fingerprints */
+      dist = 0.0;
+      for( i = 0; i < SCIP_FINGERPRINT_SIZE; i++ )
+         dist += SQR((vals[i] - fingerprint[i]) * scale[i]);
+
+      if( dist < bestdist )
+      {
+         bestdist = dist;
+         bestline = lineno;
+         polindexSetPolicy(poldir, selname, nodeselpol);
+         polindexSetPolicy(poldir, pruname, nodeprupol);
+      }
+   }
+   fclose(file);
+
+   SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL,
+      "selected policies <%s> and <%s> of line %d of file <%s> at distance %g\n", nodeselpol, nodeprupol, bestline,
+      fname, sqrt(bestdist));
+
+   return SCIP_OKAY;
+}
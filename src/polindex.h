@@ -0,0 +1,57 @@
+/**@file   polindex.h
+ * @brief  selection of the policies of an instance from a policy directory by the fingerprint of the instance
+ * @author He He
+ *
+ * The fingerprint of an instance consists of the cheap size and structure statistics of the problem as read, before
+ * presolving, that also start the instance features (see SCIPcalcProblemStats()): the numbers of variables and
+ * constraints (log10(1 + n)), the fractions of binary, integer and continuous (including implicit integer) variables,
+ * the density of the constraint matrix and the fraction of variables with a nonzero objective coefficient.
+ *
+ * A policy directory holds the policies trained on several datasets and a file "index" with one line per dataset
+ * "<search policy> <kill policy> <fingerprint>", where the policies are file names relative to the directory (or
+ * "-" for none) and the fingerprint is typically the mean over the training instances. Empty lines and lines starting
+ * with '#' are skipped. The entry whose fingerprint is nearest to the fingerprint of the instance is selected, in
+ * Euclidean distance after dividing each entry by its standard deviation over the index entries, so that the sizes
+ * (up to about 7) do not outweigh the fractions in [0,1]; entries that are equal in all index entries are ignored.
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_POLINDEX_H__
+#define __SCIP_POLINDEX_H__
+
+#include "scip/def.h"
+#include "scip/scip.h"
+#include "feat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCIP_FINGERPRINT_SIZE SCIP_FEATINST_NPROBSTATS
+#define SCIP_POLINDEX_FNAME "index"
+
+/** calculate the fingerprint of the problem; must be called after the problem was read and before it is solved */
+extern
+SCIP_RETCODE SCIPcalcFingerprint(
+   SCIP*              scip,
+   SCIP_Real*         fingerprint
+   );
+
+/** select the entry of the index of the policy directory nearest to the fingerprint; the policy file names are written
+ *  to nodeselpol and nodeprupol (size SCIP_MAXSTRLEN), or set to the empty string if the entry has none
+ */
+extern
+SCIP_RETCODE SCIPpolindexSelect(
+   SCIP*              scip,
+   const char*        poldir,
+   const SCIP_Real*   fingerprint,
+   char*              nodeselpol,
+   char*              nodeprupol
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
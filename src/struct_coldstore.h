@@ -0,0 +1,43 @@
+/**@file   struct_coldstore.h
+ * @brief  data structures for the cold store of pruned nodes
+ * @author He He
+ *
+ *  This file defines the store in which node pruners park the nodes they reject, so that they can be revisited.
+ *
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_STRUCT_COLDSTORE_H__
+#define __SCIP_STRUCT_COLDSTORE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "scip/def.h"
+
+/** store of parked nodes outside of the branch-and-bound tree
+ * A node is serialized into one record of the byte buffer, prefixed by the length of the record: its lower bound, its
+ * policy score as a float and its branchings, one per variable and bound type. The branchings are sorted and
+ * delta-encoded as varints, integral bounds are zigzag varints, so a branching on a binary variable takes two bytes.
+ */
+struct SCIP_Coldstore
+{
+   unsigned char* buf;                /**< serialized records */
+   SCIP_Longint   buflen;             /**< number of used bytes of buf */
+   SCIP_Longint   bufsize;            /**< size of buf */
+   int            nrecords;           /**< number of records */
+   SCIP_Longint   nodelimit;          /**< node limit of the sub-SCIP solving a parked node */
+   int            nparked;            /**< number of nodes parked */
+   int            nrevisited;         /**< number of parked nodes solved in a sub-SCIP */
+   int            nsols;              /**< number of improving solutions found in revisited nodes */
+   SCIP_Longint   nbytes;             /**< number of bytes of all records written */
+};
+typedef struct SCIP_Coldstore SCIP_COLDSTORE;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,6 +16,43 @@ extern "C" {
 #endif
 
 #include "scip/def.h"
+#include "scip/type_misc.h"
+#include "scip/type_tree.h"
+
+/** memo of the branching statistics of a variable in one direction, valid in the selection round it was set in */
+struct SCIP_FeatMemo
+{
+   SCIP_Real      pscost;              /**< pseudocost of a change by one */
+   SCIP_Real      inf;                 /**< average number of inferences */
+   int            pscostround;         /**< selection round pscost was set in, or 0 */
+   int            infround;            /**< selection round inf was set in, or 0 */
+};
+
+/** branching history of the path from the root to a node, including the branchings of the node */
+struct SCIP_PathRecord
+{
+   SCIP_Real      pscost;              /**< sum of the pseudocosts of the branchings, measured from the root LP solution;
+                                        *   each branching is priced when the record of its node is created, so the
+                                        *   sum mixes the pseudocosts of the times the records of the path were made */
+   int            nup;                 /**< number of upwards branchings */
+   int            ndown;               /**< number of downwards branchings */
+};
+
+/** path records of the nodes, shared by the feature vectors of a node selector or pruner; the records of nodes that
+ *  are no longer open are dropped once the number of records doubled, and rebuilt from the root if needed again
+ */
+struct SCIP_PathStore
+{
+   SCIP_PATHRECORD* paths;             /**< path records */
+   int            npaths;              /**< number of path records */
+   int            pathssize;           /**< size of paths */
+   int            ncollect;            /**< number of path records at which the records of closed nodes are dropped */
+   SCIP_HASHMAP*  pathmap;             /**< maps node numbers to their path record index + 1, or NULL */
+   int            nruns;               /**< run of the records; node numbers restart with each run */
+   SCIP_NODE**    pathnodes;           /**< buffer of the ancestors of a node without path records */
+   int            pathnodessize;       /**< size of pathnodes */
+   int            nuses;               /**< number of feature vectors using the store */
+};
 
 /** Features for node selector and pruner
  * Feature values are normalized accordingly.
@@ -32,6 +69,19 @@ struct SCIP_Feat
    int            depth;
    SCIP_BOUNDTYPE boundtype;
    int            size;
+   int            instoffset;          /**< position of the instance features in vals, or 0 if there are none */
+   SCIP_Bool      instdone;            /**< were the instance features computed? */
+   int            branchoffset;        /**< position of the branching aggregates in vals, or 0 if there are none */
+   SCIP_FEATMEMO* memo;                /**< branching statistics per variable and direction, by 2 * probindex + dir */
+   int            nmemo;               /**< number of entries of memo */
+   int            memoround;           /**< current selection round of memo */
+   SCIP_Longint   memonlps;            /**< number of LPs solved in the current selection round */
+   SCIP_Longint   memonactivatednodes; /**< number of node activations in the current selection round */
+   SCIP_Longint   memonboundchgs;      /**< number of bound changes generated in the current selection round */
+   int            pathoffset;          /**< position of the path features in vals, or 0 if there are none */
+   SCIP_PATHSTORE* pathstore;          /**< path records, possibly shared with other feature vectors, or NULL */
+   SCIP_Real      keylowerbound;       /**< lower bound the sort keys of nodes are relative to */
+   SCIP_Real      keyboundrange;       /**< range of lower bounds of the sort keys, or 0 if it is not fixed yet */
 };
 
 #ifdef __cplusplus
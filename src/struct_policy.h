@@ -1,6 +1,6 @@
 /**@file   struct_policy.h
- * @brief  data structures for node policyures 
- * @author He He 
+ * @brief  data structures for node policyures
+ * @author He He
  *
  *  This file defines the interface for node selector and pruner  policy implemented in C.
  *
@@ -16,14 +16,38 @@ extern "C" {
 #endif
 
 #include "scip/def.h"
+#include "type_policy.h"
+
+/** kind of policy, identified by the first token of its policy files */
+struct SCIP_PolicyKind
+{
+   const char*                tag;              /**< type tag starting the policy files of this kind */
+   SCIP_Bool                  pairwise;         /**< is the score of a difference of two nodes the difference of
+                                                 *   their scores, i.e., can the kind be trained on the search
+                                                 *   trajectories and rank nodes? */
+   SCIP_DECL_POLICYREAD       ((*policyread));  /**< read the model */
+   SCIP_DECL_POLICYSCORE      ((*policyscore)); /**< score one example */
+   SCIP_DECL_POLICYSCOREBATCH ((*policyscorebatch)); /**< score several examples, or NULL */
+   SCIP_DECL_POLICYFREE       ((*policyfree));  /**< free the model */
+};
 
 /** policy for node selector and pruner */
 struct SCIP_Policy
 {
-   SCIP_Real*     weights;
-   int            size;
+   const SCIP_POLICYKIND* kind;       /**< kind of the model, or NULL if none was read */
+   SCIP_POLICYDATA* data;             /**< model */
+   SCIP_Real*     normstats;          /**< mean, scale, lower and upper clipping bound of each feature and bucket, or
+                                       *   NULL if the features are not normalized */
+   SCIP_Real*     normvals;           /**< buffer of the normalized features of a node */
+   int            normsize;           /**< number of features of a node */
+   int            nnormbuckets;       /**< number of feature buckets with statistics */
+   char           calibtype;          /**< calibration of scores to probabilities ('n'one, 'p'latt, 'i'sotonic) */
+   SCIP_Real      platta;             /**< slope of the Platt calibration 1 / (1 + exp(a * score + b)) */
+   SCIP_Real      plattb;             /**< offset of the Platt calibration */
+   SCIP_Real*     calibscores;        /**< increasing scores of the isotonic calibration */
+   SCIP_Real*     calibprobs;         /**< nondecreasing probabilities at calibscores */
+   int            ncalib;             /**< number of points of the isotonic calibration */
 };
-typedef struct SCIP_Policy SCIP_POLICY;
 
 #ifdef __cplusplus
 }
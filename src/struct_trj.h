@@ -0,0 +1,55 @@
+/**@file   struct_trj.h
+ * @brief  data structures for trajectory files
+ * @author He He
+ *
+ *  This file defines the interface for writing training examples of the node selector and pruner implemented in C.
+ *
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_STRUCT_TRJ_H__
+#define __SCIP_STRUCT_TRJ_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "scip/def.h"
+#include "scip/type_misc.h"
+
+/** trajectory of training examples written in LIBSVM format, with one weight per example in a separate file
+ * Examples are kept in sparse form. If a reservoir is used, the examples of one instance are buffered and
+ * written when the trajectory is freed; the same holds if duplicate examples are merged. Weights are always buffered,
+ * since they are normalized over the instance.
+ */
+struct SCIP_Trj
+{
+   FILE*          file;               /**< trajectory file */
+   FILE*          wfile;              /**< weight file */
+   int*           idx;                /**< feature indices of the buffered examples (maxnnz per example) */
+   SCIP_Real*     vals;               /**< feature values of the buffered examples (maxnnz per example) */
+   int*           nnz;                /**< number of nonzeros of the buffered examples */
+   int*           labels;             /**< labels of the buffered examples */
+   SCIP_Real*     weights;            /**< unnormalized weights of the examples */
+   int*           buckets;            /**< feature offset buckets of the examples */
+   SCIP_Longint*  nodenums;           /**< numbers of the nodes the examples are weighted by, or -1 */
+   SCIP_HASHMAP*  subtrees;           /**< maps node numbers in examples to one plus their focused subtree size */
+   SCIP_Longint   lastfocus;          /**< number of the last counted focus node */
+   int            weightssize;        /**< size of weights, buckets and nodenums */
+   int            maxnnz;             /**< maximum number of nonzeros of an example */
+   int            maxexamples;        /**< size of the reservoir, or 0 if there is no reservoir */
+   int            nslots;             /**< number of example slots of idx, vals, nnz and labels */
+   int            nexamples;          /**< number of buffered examples (weights only if there is no reservoir) */
+   SCIP_Longint   nseen;              /**< number of examples added to the trajectory */
+   unsigned int   randseed;           /**< seed for sampling */
+   char           weightscheme;       /**< weighting scheme of the examples (see SCIP_TRJ_WEIGHTSCHEMES) */
+   SCIP_Real      dedupquant;         /**< quantization step of features for merging duplicates, or 0 */
+};
+typedef struct SCIP_Trj SCIP_TRJ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,754 @@
+/**@file   trj.c
+ * @brief  methods for trajectory files
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include "scip/def.h"
+#include "feat.h"
+#include "struct_feat.h"
+#include "trj.h"
+
+#define NDEPTHBUCKETS          10            /**< number of depth strata used in node sampling */
+#define NTYPEBUCKETS            3            /**< number of node type strata (child, sibling, leaf) */
+#define HASHMAPSIZE          1024            /**< initial size of the subtree size hash map */
+
+/** are the features of examples buffered until the trajectory is freed? */
+#define trjIsBuffered(trj)     ((trj)->maxexamples > 0 || (trj)->dedupquant > 0.0)
+
+/** gets the slot the next example should be stored in, or -1 if it is rejected by the reservoir */
+static
+SCIP_RETCODE trjGetSlot(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   int*               slot
+   )
+{
+   int j;
+
+   trj->nseen++;
+
+   if( trj->maxexamples == 0 )
+   {
+      /* no reservoir and no merging: use the only slot and write the example right away */
+      if( trj->dedupquant == 0.0 )
+      {
+         *slot = 0;
+         return SCIP_OKAY;
+      }
+
+      /* keep all examples until duplicates are merged */
+      if( trj->nexamples == trj->nslots )
+      {
+         trj->nslots = SCIPcalcMemGrowSize(scip, trj->nexamples + 1);
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->idx, trj->nslots * trj->maxnnz) );
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->vals, trj->nslots * trj->maxnnz) );
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->nnz, trj->nslots) );
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->labels, trj->nslots) );
+      }
+      *slot = trj->nexamples;
+      return SCIP_OKAY;
+   }
+
+   if( trj->nexamples < trj->maxexamples )
+   {
+      *slot = trj->nexamples++;
+      return SCIP_OKAY;
+   }
+
+   /* replace a random example with probability maxexamples/nseen */
+   j = SCIPgetRandomInt(0, (int)MIN(trj->nseen - 1, INT_MAX), &trj->randseed);
+   *slot = j < trj->maxexamples ? j : -1;
+
+   return SCIP_OKAY;
+}
+
+/** store the weight information of the example in slot; without a reservoir, it is appended to the buffered weights,
+ *  which grow along with the slots if examples are merged
+ */
+static
+SCIP_RETCODE trjStoreWeight(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   int                slot,
+   SCIP_FEAT*         feat,
+   SCIP_NODE*         node,
+   SCIP_Real          mult
+   )
+{
+   int i;
+
+   if( trj->maxexamples == 0 )
+   {
+      if( trj->nexamples == trj->weightssize )
+      {
+         trj->weightssize = SCIPcalcMemGrowSize(scip, trj->nexamples + 1);
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->weights, trj->weightssize) );
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->buckets, trj->weightssize) );
+         SCIP_CALL( SCIPreallocMemoryArray(scip, &trj->nodenums, trj->weightssize) );
+      }
+      i = trj->nexamples++;
+   }
+   else
+      i = slot;
+
+   trj->weights[i] = (trj->weightscheme == 'd' ? SCIPfeatGetWeight(feat) : 1.0) * mult;
+   trj->buckets[i] = SCIPfeatGetOffset(feat) / SCIPfeatGetSize(feat);
+   trj->nodenums[i] = node == NULL ? -1 : SCIPnodeGetNumber(node);
+
+   /* start counting the focused nodes in the subtree */
+   if( trj->subtrees != NULL && node != NULL && !SCIPhashmapExists(trj->subtrees, (void*)(size_t)trj->nodenums[i]) )
+   {
+      SCIP_CALL( SCIPhashmapInsert(trj->subtrees, (void*)(size_t)trj->nodenums[i], (void*)(size_t)1) );
+   }
+
+   return SCIP_OKAY;
+}
+
+/** compute the final weights of all examples, normalized to mean one */
+static
+SCIP_RETCODE trjComputeWeights(
+   SCIP*              scip,
+   SCIP_TRJ*          trj
+   )
+{
+   SCIP_Real* bucketsums;
+   SCIP_Real sum;
+   int nbuckets;
+   int i;
+
+   if( trj->nexamples == 0 )
+      return SCIP_OKAY;
+
+   nbuckets = 0;
+   for( i = 0; i < trj->nexamples; i++ )
+      nbuckets = MAX(nbuckets, trj->buckets[i] + 1);
+   SCIP_CALL( SCIPallocBufferArray(scip, &bucketsums, nbuckets) );
+   BMSclearMemoryArray(bucketsums, nbuckets);
+   for( i = 0; i < trj->nexamples; i++ )
+      bucketsums[trj->buckets[i]] += trj->weights[i];
+
+   sum = 0.0;
+   for( i = 0; i < trj->nexamples; i++ )
+   {
+      switch( trj->weightscheme )
+      {
+      case 'f':
+         /* each bucket gets the same total weight */
+         trj->weights[i] /= bucketsums[trj->buckets[i]];
+         break;
+      case 's':
+         /* image is one plus the number of focused nodes in the subtree */
+         if( trj->nodenums[i] != -1 )
+            trj->weights[i] *= log(1.0 + (size_t)SCIPhashmapGetImage(trj->subtrees, (void*)(size_t)trj->nodenums[i]))
+               / log(2.0);
+         break;
+      default:
+         break;
+      }
+      sum += trj->weights[i];
+   }
+
+   assert(sum > 0.0);
+   for( i = 0; i < trj->nexamples; i++ )
+      trj->weights[i] *= trj->nexamples / sum;
+
+   SCIPfreeBufferArray(scip, &bucketsums);
+
+   return SCIP_OKAY;
+}
+
+/** gets the key of an example, which is one plus its slot */
+static
+SCIP_DECL_HASHGETKEY(hashGetKeyExample)
+{  /*lint --e{715}*/
+   return elem;
+}
+
+/** returns TRUE iff the two examples have the same label, bucket and quantized features */
+static
+SCIP_DECL_HASHKEYEQ(hashKeyEqExample)
+{
+   SCIP_TRJ* trj;
+   int slot1;
+   int slot2;
+   int i;
+
+   trj = (SCIP_TRJ*)userptr;
+   slot1 = (int)(size_t)key1 - 1;
+   slot2 = (int)(size_t)key2 - 1;
+
+   if( trj->labels[slot1] != trj->labels[slot2] || trj->buckets[slot1] != trj->buckets[slot2]
+      || trj->nnz[slot1] != trj->nnz[slot2] )
+      return FALSE;
+
+   for( i = 0; i < trj->nnz[slot1]; i++ )
+   {
+      if( trj->idx[slot1 * trj->maxnnz + i] != trj->idx[slot2 * trj->maxnnz + i]
+         || trj->vals[slot1 * trj->maxnnz + i] != trj->vals[slot2 * trj->maxnnz + i] ) /*lint !e777*/
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+/** returns the hash value of the label, bucket and quantized features of an example */
+static
+SCIP_DECL_HASHKEYVAL(hashKeyValExample)
+{
+   SCIP_TRJ* trj;
+   unsigned int hash;
+   int slot;
+   int i;
+
+   trj = (SCIP_TRJ*)userptr;
+   slot = (int)(size_t)key - 1;
+
+   hash = (unsigned int)(trj->labels[slot] + 2) * 31u + (unsigned int)trj->buckets[slot];
+   for( i = 0; i < trj->nnz[slot]; i++ )
+   {
+      hash = hash * 31u + (unsigned int)trj->idx[slot * trj->maxnnz + i];
+      hash = hash * 31u + (unsigned int)(SCIP_Longint)floor(trj->vals[slot * trj->maxnnz + i] / trj->dedupquant + 0.5);
+   }
+
+   return hash;
+}
+
+/** quantize the features of the buffered examples and merge duplicates into the first one, summing up their weights;
+ *  merged examples get nnz -1
+ */
+static
+SCIP_RETCODE trjMergeExamples(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   int*               nmerged
+   )
+{
+   SCIP_HASHTABLE* hashtable;
+   int i;
+
+   assert(trj->dedupquant > 0.0);
+
+   *nmerged = 0;
+   if( trj->nexamples == 0 )
+      return SCIP_OKAY;
+
+   for( i = 0; i < trj->nexamples; i++ )
+   {
+      SCIP_Real* vals = &trj->vals[i * trj->maxnnz];
+      int j;
+
+      for( j = 0; j < trj->nnz[i]; j++ )
+         vals[j] = trj->dedupquant * floor(vals[j] / trj->dedupquant + 0.5);
+   }
+
+   SCIP_CALL( SCIPhashtableCreate(&hashtable, SCIPblkmem(scip), SCIPcalcHashtableSize(trj->nexamples),
+         hashGetKeyExample, hashKeyEqExample, hashKeyValExample, (void*)trj) );
+
+   for( i = 0; i < trj->nexamples; i++ )
+   {
+      void* dup;
+
+      dup = SCIPhashtableRetrieve(hashtable, (void*)(size_t)(i + 1));
+      if( dup != NULL )
+      {
+         trj->weights[(int)(size_t)dup - 1] += trj->weights[i];
+         trj->nnz[i] = -1;
+         (*nmerged)++;
+      }
+      else
+      {
+         SCIP_CALL( SCIPhashtableInsert(hashtable, (void*)(size_t)(i + 1)) );
+      }
+   }
+
+   SCIPhashtableFree(&hashtable);
+
+   return SCIP_OKAY;
+}
+
+/** write features of the example in slot to the trajectory file */
+static
+void trjWriteExample(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   int                slot
+   )
+{
+   int* idx;
+   SCIP_Real* vals;
+   int i;
+
+   idx = &trj->idx[slot * trj->maxnnz];
+   vals = &trj->vals[slot * trj->maxnnz];
+
+   SCIPinfoMessage(scip, trj->file, "%d ", trj->labels[slot]);
+   for( i = 0; i < trj->nnz[slot]; i++ )
+      SCIPinfoMessage(scip, trj->file, "%d:%f ", idx[i], vals[i]);
+   SCIPinfoMessage(scip, trj->file, "\n");
+}
+
+/** append feature vector (negated if requested) to the example in slot */
+static
+void trjAppendFeat(
+   SCIP_TRJ*          trj,
+   int                slot,
+   SCIP_FEAT*         feat,
+   SCIP_Real          sign
+   )
+{
+   int* idx;
+   SCIP_Real* vals;
+   int offset;
+   int n;
+   int i;
+
+   idx = &trj->idx[slot * trj->maxnnz];
+   vals = &trj->vals[slot * trj->maxnnz];
+   n = trj->nnz[slot];
+   offset = SCIPfeatGetOffset(feat);
+
+   assert(n + SCIPfeatGetSize(feat) <= trj->maxnnz);
+
+   for( i = 0; i < SCIPfeatGetSize(feat); i++ )
+   {
+      idx[n] = i + offset + 1;
+      vals[n] = sign * feat->vals[i];
+      n++;
+   }
+   trj->nnz[slot] = n;
+}
+
+/** open trajectory file <fname> and weight file <fname>.weight in appending mode;
+ *  if maxexamples > 0, a reservoir sample of at most maxexamples examples is written when the trajectory is freed;
+ *  the weights are computed by weightscheme and written when the trajectory is freed;
+ *  if dedupquant > 0, features are rounded to multiples of dedupquant and duplicate examples are merged
+ */
+SCIP_RETCODE SCIPtrjCreate(
+   SCIP*              scip,
+   SCIP_TRJ**         trj,
+   const char*        fname,
+   int                featsize,
+   int                maxexamples,
+   char               weightscheme,
+   SCIP_Real          dedupquant
+   )
+{
+   char wfname[SCIP_MAXSTRLEN];
+   int nslots;
+
+   assert(scip != NULL);
+   assert(trj != NULL);
+   assert(fname != NULL);
+   assert(featsize > 0);
+   assert(maxexamples >= 0);
+   assert(strchr(SCIP_TRJ_WEIGHTSCHEMES, weightscheme) != NULL);
+   assert(dedupquant >= 0.0);
+
+   SCIP_CALL( SCIPallocBlockMemory(scip, trj) );
+
+   /* open in appending mode for writing training file from multiple problems */
+   (void) SCIPsnprintf(wfname, SCIP_MAXSTRLEN, "%s.weight", fname);
+   (*trj)->file = fopen(fname, "a");
+   (*trj)->wfile = fopen(wfname, "a");
+   if( (*trj)->file == NULL || (*trj)->wfile == NULL )
+   {
+      SCIPerrorMessage("cannot open trajectory file <%s> for writing\n", fname);
+      SCIPprintSysError(fname);
+      if( (*trj)->file != NULL )
+         fclose((*trj)->file);
+      if( (*trj)->wfile != NULL )
+         fclose((*trj)->wfile);
+      SCIPfreeBlockMemory(scip, trj);
+      return SCIP_FILECREATEERROR;
+   }
+
+   /* a pairwise example has the features of two nodes */
+   (*trj)->maxnnz = 2 * featsize;
+   (*trj)->maxexamples = maxexamples;
+   (*trj)->nexamples = 0;
+   (*trj)->nseen = 0;
+   (*trj)->randseed = 0;
+   (*trj)->weightscheme = weightscheme;
+   (*trj)->lastfocus = -1;
+   (*trj)->dedupquant = dedupquant;
+
+   nslots = MAX(maxexamples, 1);
+   (*trj)->nslots = nslots;
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->idx, nslots * (*trj)->maxnnz) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->vals, nslots * (*trj)->maxnnz) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->nnz, nslots) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->labels, nslots) );
+
+   (*trj)->weightssize = nslots;
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->weights, nslots) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->buckets, nslots) );
+   SCIP_CALL( SCIPallocMemoryArray(scip, &(*trj)->nodenums, nslots) );
+
+   (*trj)->subtrees = NULL;
+   if( weightscheme == 's' )
+   {
+      SCIP_CALL( SCIPhashmapCreate(&(*trj)->subtrees, SCIPblkmem(scip), SCIPcalcHashtableSize(HASHMAPSIZE)) );
+   }
+
+   return SCIP_OKAY;
+}
+
+/** write buffered examples and close the trajectory files */
+SCIP_RETCODE SCIPtrjFree(
+   SCIP*              scip,
+   SCIP_TRJ**         trj
+   )
+{
+   int i;
+
+   assert(scip != NULL);
+   assert(trj != NULL);
+   assert(*trj != NULL);
+
+   /* every example was kept with the same probability nexamples/nseen, which cancels out in the normalized weights */
+   SCIP_CALL( trjComputeWeights(scip, *trj) );
+   if( (*trj)->maxexamples > 0 && (*trj)->nexamples > 0 )
+   {
+      SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL, "kept %d of %"SCIP_LONGINT_FORMAT" examples of trajectory\n",
+         (*trj)->nexamples, (*trj)->nseen);
+   }
+
+   if( (*trj)->dedupquant > 0.0 )
+   {
+      int nmerged;
+
+      SCIP_CALL( trjMergeExamples(scip, *trj, &nmerged) );
+      SCIPverbMessage(scip, SCIP_VERBLEVEL_NORMAL, NULL, "merged %d of %d examples of trajectory into duplicates\n",
+         nmerged, (*trj)->nexamples);
+   }
+
+   /* without buffering, the features have been written already */
+   for( i = 0; i < (*trj)->nexamples; i++ )
+   {
+      if( trjIsBuffered(*trj) )
+      {
+         if( (*trj)->nnz[i] == -1 )
+            continue;
+         trjWriteExample(scip, *trj, i);
+      }
+      SCIPinfoMessage(scip, (*trj)->wfile, "%f\n", (*trj)->weights[i]);
+   }
+
+   fclose((*trj)->file);
+   fclose((*trj)->wfile);
+
+   SCIPfreeMemoryArray(scip, &(*trj)->idx);
+   SCIPfreeMemoryArray(scip, &(*trj)->vals);
+   SCIPfreeMemoryArray(scip, &(*trj)->nnz);
+   SCIPfreeMemoryArray(scip, &(*trj)->labels);
+   SCIPfreeMemoryArray(scip, &(*trj)->weights);
+   SCIPfreeMemoryArray(scip, &(*trj)->buckets);
+   SCIPfreeMemoryArray(scip, &(*trj)->nodenums);
+   if( (*trj)->subtrees != NULL )
+      SCIPhashmapFree(&(*trj)->subtrees);
+   SCIPfreeBlockMemory(scip, trj);
+
+   return SCIP_OKAY;
+}
+
+/** add feature vector of node as an example; its weight is multiplied by mult */
+SCIP_RETCODE SCIPtrjAddFeat(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_FEAT*         feat,
+   SCIP_NODE*         node,
+   int                label,
+   SCIP_Real          mult
+   )
+{
+   int slot;
+
+   assert(scip != NULL);
+   assert(trj != NULL);
+   assert(feat != NULL);
+   assert(feat->depth != 0);
+
+   SCIP_CALL( trjGetSlot(scip, trj, &slot) );
+   if( slot == -1 )
+      return SCIP_OKAY;
+
+   SCIP_CALL( trjStoreWeight(scip, trj, slot, feat, node, mult) );
+   trj->labels[slot] = label;
+   trj->nnz[slot] = 0;
+   trjAppendFeat(trj, slot, feat, 1.0);
+
+   if( !trjIsBuffered(trj) )
+      trjWriteExample(scip, trj, slot);
+
+   return SCIP_OKAY;
+}
+
+/** add feature vector diff (feat1 - feat2) as an example; its weight is computed from feat1 and the subtree of node,
+ *  and multiplied by mult
+ */
+SCIP_RETCODE SCIPtrjAddFeatDiff(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_FEAT*         feat1,
+   SCIP_FEAT*         feat2,
+   SCIP_NODE*         node,
+   int                label,
+   SCIP_Bool          negate,
+   SCIP_Real          mult
+   )
+{
+   int slot;
+   int offset1;
+   int offset2;
+
+   assert(scip != NULL);
+   assert(trj != NULL);
+   assert(feat1 != NULL);
+   assert(feat2 != NULL);
+   assert(feat1->depth != 0);
+   assert(feat2->depth != 0);
+   assert(feat1->size == feat2->size);
+
+   SCIP_CALL( trjGetSlot(scip, trj, &slot) );
+   if( slot == -1 )
+      return SCIP_OKAY;
+
+   SCIP_CALL( trjStoreWeight(scip, trj, slot, feat1, node, mult) );
+
+   if( negate )
+   {
+      SCIP_FEAT* tmp = feat1;
+      feat1 = feat2;
+      feat2 = tmp;
+      label = -1 * label;
+   }
+
+   trj->labels[slot] = label;
+   trj->nnz[slot] = 0;
+   offset1 = SCIPfeatGetOffset(feat1);
+   offset2 = SCIPfeatGetOffset(feat2);
+
+   if( offset1 == offset2 )
+   {
+      int* idx = &trj->idx[slot * trj->maxnnz];
+      SCIP_Real* vals = &trj->vals[slot * trj->maxnnz];
+      int i;
+
+      for( i = 0; i < feat1->size; i++ )
+      {
+         idx[i] = i + offset1 + 1;
+         vals[i] = feat1->vals[i] - feat2->vals[i];
+      }
+      trj->nnz[slot] = feat1->size;
+   }
+   /* libsvm requires sorted indices, write smaller indices first */
+   else if( offset1 < offset2 )
+   {
+      trjAppendFeat(trj, slot, feat1, 1.0);
+      trjAppendFeat(trj, slot, feat2, -1.0);
+   }
+   else
+   {
+      trjAppendFeat(trj, slot, feat2, -1.0);
+      trjAppendFeat(trj, slot, feat1, 1.0);
+   }
+
+   if( !trjIsBuffered(trj) )
+      trjWriteExample(scip, trj, slot);
+
+   return SCIP_OKAY;
+}
+
+/** count focused node in the subtrees of its ancestors that are in examples; only needed by subtree size weights */
+SCIP_RETCODE SCIPtrjCountFocus(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_NODE*         node
+   )
+{
+   assert(scip != NULL);
+   assert(trj != NULL);
+
+   if( trj->subtrees == NULL || node == NULL || SCIPnodeGetNumber(node) == trj->lastfocus )
+      return SCIP_OKAY;
+   trj->lastfocus = SCIPnodeGetNumber(node);
+
+   for( ; node != NULL; node = SCIPnodeGetParent(node) )
+   {
+      void* key = (void*)(size_t)SCIPnodeGetNumber(node);
+
+      if( SCIPhashmapExists(trj->subtrees, key) )
+      {
+         SCIP_CALL( SCIPhashmapSetImage(trj->subtrees, key, (void*)((size_t)SCIPhashmapGetImage(trj->subtrees, key) + 1)) );
+      }
+   }
+
+   return SCIP_OKAY;
+}
+
+/** draw a sample of at most maxsample nodes, stratified by node type and depth; strata too small for their share
+ *  compete for the remaining slots, each getting one node with probability proportional to its size (by systematic
+ *  sampling), so that every node has a positive selection probability;
+ *  mults[i] is set to the inverse selection probability of nodes[i] if it is sampled, and 0 otherwise
+ */
+SCIP_RETCODE SCIPtrjSampleNodes(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_NODE**        nodes,
+   int                nnodes,
+   int                maxdepth,
+   int                maxsample,
+   SCIP_Real*         mults
+   )
+{
+   int nstratum[NTYPEBUCKETS * NDEPTHBUCKETS];
+   int quota[NTYPEBUCKETS * NDEPTHBUCKETS];
+   int nleft[NTYPEBUCKETS * NDEPTHBUCKETS];
+   int nunseen[NTYPEBUCKETS * NDEPTHBUCKETS];
+   SCIP_Real incl[NTYPEBUCKETS * NDEPTHBUCKETS];
+   int* stratum;
+   SCIP_Real cum;
+   SCIP_Real u;
+   int nsmall;
+   int nquota;
+   int nrest;
+   int s;
+   int i;
+
+   assert(scip != NULL);
+   assert(trj != NULL);
+   assert(nodes != NULL || nnodes == 0);
+   assert(mults != NULL || nnodes == 0);
+   assert(maxdepth > 0);
+
+   /* take all nodes if there are not too many */
+   if( maxsample <= 0 || nnodes <= maxsample )
+   {
+      for( i = 0; i < nnodes; i++ )
+         mults[i] = 1.0;
+      return SCIP_OKAY;
+   }
+
+   SCIP_CALL( SCIPallocBufferArray(scip, &stratum, nnodes) );
+
+   BMSclearMemoryArray(nstratum, NTYPEBUCKETS * NDEPTHBUCKETS);
+   for( i = 0; i < nnodes; i++ )
+   {
+      int type;
+      int depth;
+
+      switch( SCIPnodeGetType(nodes[i]) )
+      {
+      case SCIP_NODETYPE_CHILD:
+         type = 0;
+         break;
+      case SCIP_NODETYPE_SIBLING:
+         type = 1;
+         break;
+      default:
+         type = 2;
+         break;
+      }
+      depth = (int)((SCIP_Real)SCIPnodeGetDepth(nodes[i]) / (SCIP_Real)maxdepth * NDEPTHBUCKETS);
+      depth = MAX(0, MIN(depth, NDEPTHBUCKETS - 1));
+
+      stratum[i] = type * NDEPTHBUCKETS + depth;
+      nstratum[stratum[i]]++;
+   }
+
+   /* proportional allocation, rounded down */
+   nquota = 0;
+   for( s = 0; s < NTYPEBUCKETS * NDEPTHBUCKETS; s++ )
+   {
+      quota[s] = (int)((SCIP_Real)maxsample * nstratum[s] / nnodes);
+      nquota += quota[s];
+   }
+   assert(nquota <= maxsample);
+
+   /* the non-empty strata without a node yet compete for the rest: one with at least the expected share of a slot
+    * gets one for certain; the others get one with probability nrest * size / (summed size), which sums to nrest
+    */
+   for( s = 0; s < NTYPEBUCKETS * NDEPTHBUCKETS; s++ )
+      incl[s] = 1.0;
+   nrest = maxsample - nquota;
+   while( nrest > 0 )
+   {
+      int best = -1;
+
+      nsmall = 0;
+      for( s = 0; s < NTYPEBUCKETS * NDEPTHBUCKETS; s++ )
+      {
+         if( nstratum[s] > 0 && quota[s] == 0 )
+         {
+            nsmall += nstratum[s];
+            if( best == -1 || nstratum[s] > nstratum[best] )
+               best = s;
+         }
+      }
+      if( best == -1 || (SCIP_Real)nrest * nstratum[best] < (SCIP_Real)nsmall )
+         break;
+      quota[best] = 1;
+      nquota++;
+      nrest--;
+   }
+
+   if( nrest > 0 )
+   {
+      nsmall = 0;
+      for( s = 0; s < NTYPEBUCKETS * NDEPTHBUCKETS; s++ )
+      {
+         if( nstratum[s] > 0 && quota[s] == 0 )
+            nsmall += nstratum[s];
+      }
+
+      /* systematic sampling: the strata whose interval of the cumulated probabilities contains one of u, u+1, ... */
+      u = SCIPgetRandomReal(0.0, 1.0, &trj->randseed);
+      cum = 0.0;
+      for( s = 0; s < NTYPEBUCKETS * NDEPTHBUCKETS && nsmall > 0; s++ )
+      {
+         if( nstratum[s] > 0 && quota[s] == 0 )
+         {
+            SCIP_Real lo = cum;
+
+            incl[s] = (SCIP_Real)nrest * nstratum[s] / nsmall;
+            assert(incl[s] < 1.0);
+            cum += incl[s];
+            if( floor(cum - u) > floor(lo - u) && nquota < maxsample )
+            {
+               quota[s] = 1;
+               nquota++;
+            }
+         }
+      }
+   }
+   assert(nquota <= maxsample);
+
+   for( s = 0; s < NTYPEBUCKETS * NDEPTHBUCKETS; s++ )
+   {
+      nleft[s] = quota[s];
+      nunseen[s] = nstratum[s];
+   }
+
+   /* selection sampling within each stratum: take a node with probability (quota left)/(nodes left) */
+   for( i = 0; i < nnodes; i++ )
+   {
+      s = stratum[i];
+      if( SCIPgetRandomInt(0, nunseen[s] - 1, &trj->randseed) < nleft[s] )
+      {
+         mults[i] = (SCIP_Real)nstratum[s] / ((SCIP_Real)quota[s] * incl[s]);
+         nleft[s]--;
+      }
+      else
+         mults[i] = 0.0;
+      nunseen[s]--;
+   }
+
+   SCIPfreeBufferArray(scip, &stratum);
+
+   return SCIP_OKAY;
+}
@@ -0,0 +1,102 @@
+/**@file   trj.h
+ * @brief  internal methods for trajectory files
+ * @author He He
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_TRJ_H__
+#define __SCIP_TRJ_H__
+
+#include "scip/def.h"
+#include "scip/scip.h"
+#include "feat.h"
+#include "struct_trj.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** weighting schemes of examples: 'd'epth decay, 'u'niform, inverse 'f'requency of the feature offset bucket and
+ *  's'ubtree size of the node
+ */
+#define SCIP_TRJ_WEIGHTSCHEMES "dufs"
+
+/** open trajectory file <fname> and weight file <fname>.weight in appending mode;
+ *  if maxexamples > 0, a reservoir sample of at most maxexamples examples is written when the trajectory is freed;
+ *  the weights are computed by weightscheme and written when the trajectory is freed;
+ *  if dedupquant > 0, features are rounded to multiples of dedupquant and duplicate examples are merged
+ */
+extern
+SCIP_RETCODE SCIPtrjCreate(
+   SCIP*              scip,
+   SCIP_TRJ**         trj,
+   const char*        fname,
+   int                featsize,
+   int                maxexamples,
+   char               weightscheme,
+   SCIP_Real          dedupquant
+   );
+
+/** write buffered examples and close the trajectory files */
+extern
+SCIP_RETCODE SCIPtrjFree(
+   SCIP*              scip,
+   SCIP_TRJ**         trj
+   );
+
+/** add feature vector of node as an example; its weight is multiplied by mult */
+extern
+SCIP_RETCODE SCIPtrjAddFeat(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_FEAT*         feat,
+   SCIP_NODE*         node,
+   int                label,
+   SCIP_Real          mult
+   );
+
+/** add feature vector diff (feat1 - feat2) as an example; its weight is computed from feat1 and the subtree of node,
+ *  and multiplied by mult
+ */
+extern
+SCIP_RETCODE SCIPtrjAddFeatDiff(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_FEAT*         feat1,
+   SCIP_FEAT*         feat2,
+   SCIP_NODE*         node,
+   int                label,
+   SCIP_Bool          negate,
+   SCIP_Real          mult
+   );
+
+/** count focused node in the subtrees of its ancestors that are in examples; only needed by subtree size weights */
+extern
+SCIP_RETCODE SCIPtrjCountFocus(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_NODE*         node
+   );
+
+/** draw a sample of at most maxsample nodes, stratified by node type and depth; strata too small for their share
+ *  compete for the remaining slots, each getting one node with probability proportional to its size (by systematic
+ *  sampling), so that every node has a positive selection probability;
+ *  mults[i] is set to the inverse selection probability of nodes[i] if it is sampled, and 0 otherwise
+ */
+extern
+SCIP_RETCODE SCIPtrjSampleNodes(
+   SCIP*              scip,
+   SCIP_TRJ*          trj,
+   SCIP_NODE**        nodes,
+   int                nnodes,
+   int                maxdepth,
+   int                maxsample,
+   SCIP_Real*         mults
+   );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
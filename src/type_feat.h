@@ -12,6 +12,8 @@
 #ifndef __SCIP_TYPE_FEAT_H__
 #define __SCIP_TYPE_FEAT_H__
 
+#include "scip/def.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,7 +28,7 @@ typedef enum SCIP_FeatType SCIP_FEATTYPE;
 
 /** node selector features */
 /** features are respective to the depth and the branch direction */
-/* TODO: remove inf; scale of objconstr is off; add relative bounds to parent node? */
+/* TODO: remove inf; scale of objconstr is off */
 enum SCIP_FeatNodesel
 {
    SCIP_FEATNODESEL_LOWERBOUND               = 0,
@@ -73,11 +75,66 @@ enum SCIP_FeatNodepru
 };
 typedef enum SCIP_FeatNodepru SCIP_FEATNODEPRU;     /**< feature of node */
 
+/** instance features, computed once per instance and appended to the node features if requested */
+enum SCIP_FeatInst
+{
+   SCIP_FEATINST_NVARS                       = 0,
+   SCIP_FEATINST_NCONSS                      = 1,
+   SCIP_FEATINST_BINFRAC                     = 2,
+   SCIP_FEATINST_INTFRAC                     = 3,
+   SCIP_FEATINST_CONTFRAC                    = 4,
+   SCIP_FEATINST_DENSITY                     = 5,
+   SCIP_FEATINST_OBJDENSITY                  = 6,
+   SCIP_FEATINST_OBJVARIATION                = 7,
+   SCIP_FEATINST_ROOTFRAC                    = 8,
+   SCIP_FEATINST_ROOTITERS                   = 9
+};
+typedef enum SCIP_FeatInst SCIP_FEATINST;           /**< feature of instance */
+
+/** aggregates over the branching bound changes of a node, appended to the node features if requested; the sums are
+ *  part of the node features
+ */
+enum SCIP_FeatBranch
+{
+   SCIP_FEATBRANCH_NBRANCHINGS               = 0,
+   SCIP_FEATBRANCH_MAXPSEUDOCOST             = 1,
+   SCIP_FEATBRANCH_MAXINF                    = 2,
+   SCIP_FEATBRANCH_MAXBOUNDLPDIFF            = 3
+};
+typedef enum SCIP_FeatBranch SCIP_FEATBRANCH;       /**< feature of the branchings of a node */
+
+/** features of the path from the root to a node, appended to the node features if requested */
+enum SCIP_FeatPath
+{
+   SCIP_FEATPATH_PARENTBOUNDDELTA            = 0,
+   SCIP_FEATPATH_NUP                         = 1,
+   SCIP_FEATPATH_NDOWN                       = 2,
+   SCIP_FEATPATH_PSEUDOCOST                  = 3
+};
+typedef enum SCIP_FeatPath SCIP_FEATPATH;           /**< feature of the path to a node */
+
+/** optional families of features appended to the features of a node, set by the parameters of a node selector or
+ *  pruner (see SCIPfeatAddOptsParams()) and applied by SCIPfeatCreateExt()
+ */
+struct SCIP_FeatOpts
+{
+   SCIP_Bool          instfeats;          /**< append the instance features to the node features? */
+   SCIP_Bool          branchfeats;        /**< append the branching aggregates to the node features? */
+   SCIP_Bool          pathfeats;          /**< append the path features to the node features? */
+};
 
 typedef struct SCIP_Feat SCIP_FEAT;
+typedef struct SCIP_FeatOpts SCIP_FEATOPTS;
+typedef struct SCIP_FeatMemo SCIP_FEATMEMO;
+typedef struct SCIP_PathRecord SCIP_PATHRECORD;
+typedef struct SCIP_PathStore SCIP_PATHSTORE;
 
 #define SCIP_FEATNODESEL_SIZE 18 
 #define SCIP_FEATNODEPRU_SIZE 16 
+#define SCIP_FEATINST_SIZE 10
+#define SCIP_FEATINST_NPROBSTATS 7     /**< number of leading instance features computed from the problem alone */
+#define SCIP_FEATBRANCH_SIZE 4
+#define SCIP_FEATPATH_SIZE 4
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,56 @@
+/**@file   type_policy.h
+ * @ingroup TYPEDEFINITIONS
+ * @brief  type definitions for node selector and pruner policies
+ * @author He He
+ *
+ *  This file defines the interface for kinds of policies (models) implemented in C. A kind is a table of callbacks
+ *  that read a model and score examples; the node selectors and pruners only see the policy handle.
+ *
+ */
+
+/*---+----1----+----2----+----3----+----4----+----5----+----6----+----7----+----8----+----9----+----0----+----1----+----2*/
+
+#ifndef __SCIP_TYPE_POLICY_H__
+#define __SCIP_TYPE_POLICY_H__
+
+#include <stdio.h>
+#include "scip/def.h"
+#include "scip/type_scip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SCIP_Policy SCIP_POLICY;           /**< policy of a node selector or pruner */
+typedef struct SCIP_PolicyKind SCIP_POLICYKIND;   /**< callbacks of a kind of policy */
+typedef struct SCIP_PolicyData SCIP_POLICYDATA;   /**< model of a kind of policy */
+
+/** reads the model following the type tag of the policy file
+ *
+ *  input:
+ *  - scip            : SCIP main data structure
+ *  - file            : policy file, positioned after the type tag
+ *  - fname           : name of the policy file
+ *  - policydata      : pointer to store the model
+ */
+#define SCIP_DECL_POLICYREAD(x) SCIP_RETCODE x (SCIP* scip, FILE* file, const char* fname, SCIP_POLICYDATA** policydata)
+
+/** returns the score of an example, i.e., of the features featvals[0], ..., featvals[size-1] with the LIBSVM indices
+ *  offset + 1, ..., offset + size
+ */
+#define SCIP_DECL_POLICYSCORE(x) SCIP_Real x (SCIP_POLICYDATA* policydata, SCIP_Real* featvals, int offset, int size)
+
+/** stores the scores of n examples, whose features are stored one after another in featvals, in scores; kinds
+ *  without this callback score the examples one by one
+ */
+#define SCIP_DECL_POLICYSCOREBATCH(x) void x (SCIP_POLICYDATA* policydata, SCIP_Real* featvals, int* offsets, \
+      int size, int n, SCIP_Real* scores)
+
+/** frees the model */
+#define SCIP_DECL_POLICYFREE(x) void x (SCIP* scip, SCIP_POLICYDATA** policydata)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif